@@ -0,0 +1,37 @@
+#!/bin/sh
+#
+# Compare the cost per accuracy of the two polynomial spaces: the problems of
+# the batch file are solved once with the tensor-product polynomials Q_k and
+# once with the complete polynomials P_k, and the numbers of degrees of
+# freedom, the errors and the wall times of both runs are written side by
+# side to element_comparison.csv, one line per problem.
+#
+# Usage: ./element_comparison.sh [parameter file] [number of MPI processes]
+
+PRM=${1:-step-82.prm}
+RANKS=${2:-1}
+
+for space in Q P; do
+  sed -e "s/set Run mode *=.*/set Run mode = batch/" \
+    -e "s/set Polynomial space *=.*/set Polynomial space = $space/" \
+    -e "s/set Batch output file *=.*/set Batch output file = $space.csv/" \
+    "$PRM" > element_comparison.prm
+
+  echo "=== Polynomial space $space ==="
+  mpirun -np "$RANKS" ./step-82 element_comparison.prm || exit 1
+done
+
+# The columns of a batch output file are problem, refinements, degree, the two
+# penalty coefficients, dofs, the errors in H2, H1 and L2, the wall time and
+# the process; those of the second file follow at an offset of 11.
+paste -d, Q.csv P.csv | awk -F, '
+  NR == 1 {
+    print "refinements,degree,penalty_jump_grad,penalty_jump_val," \
+          "dofs_Q,dofs_P,error_H2_Q,error_H2_P,error_L2_Q,error_L2_P," \
+          "wall_time_Q,wall_time_P"
+    next
+  }
+  { print $2 "," $3 "," $4 "," $5 "," $6 "," $17 "," $7 "," $18 "," \
+          $9 "," $20 "," $10 "," $21 }' > element_comparison.csv
+
+rm -f element_comparison.prm Q.csv P.csv
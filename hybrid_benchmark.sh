@@ -0,0 +1,42 @@
+#!/bin/sh
+#
+# Compare the ways of splitting the cores of one node into MPI processes and
+# threads: the program is run with 1, 2, 4, ... MPI processes, each of them
+# using (number of cores) / (number of processes) threads, and the timing
+# summary of each run is printed. All runs use the same backend, since the
+# deal.II backend runs on a single process only and 'auto' would compare its
+# solvers with those of PETSc. With PETSc and Trilinos, the threads speed up
+# the assembly and the error computation, while the products with the matrix
+# and the solvers only use the MPI processes.
+#
+# Usage: ./hybrid_benchmark.sh [parameter file] [number of cores]
+#                              [petsc|trilinos]
+
+PRM=${1:-step-82.prm}
+CORES=${2:-$(nproc)}
+BACKEND=${3:-petsc}
+
+ranks=1
+while [ "$ranks" -le "$CORES" ]; do
+  threads=$((CORES / ranks))
+
+  # Later entries override earlier ones, so these are appended to a copy of
+  # the parameter file, whether or not it lists them.
+  cat "$PRM" - > hybrid_benchmark.prm <<END
+
+subsection Linear solver
+  set Backend = $BACKEND
+end
+
+subsection Parallelization
+  set Number of threads per process = $threads
+end
+END
+
+  echo "=== $ranks MPI processes x $threads threads, $BACKEND ==="
+  mpirun -np "$ranks" ./step-82 hybrid_benchmark.prm | sed -n '/^+-/,$p'
+
+  ranks=$((ranks * 2))
+done
+
+rm -f hybrid_benchmark.prm
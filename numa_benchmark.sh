@@ -0,0 +1,40 @@
+#!/bin/sh
+#
+# Compare the placement of the memory on the NUMA domains of one node. A
+# single MPI process with the deal.II backend and pinned threads runs on all
+# cores of the node, so that its memory may lie on any domain, and is run
+# three times: with the vectors zeroed by all threads, which spreads their
+# pages over the domains of the threads, with the vectors zeroed by the main
+# thread, which places them on its domain, and with all pages interleaved
+# over the domains. The timing summary of each run is printed. Requires
+# numactl.
+#
+# Usage: ./numa_benchmark.sh [parameter file]
+
+PRM=${1:-step-82.prm}
+
+for run in "true --localalloc" "false --localalloc" "true --interleave=all"; do
+  set -- $run
+  touch=$1
+  policy=$2
+
+  # Later entries override earlier ones, so the settings of the benchmark
+  # are appended to the parameter file.
+  cat "$PRM" - > numa_benchmark.prm <<END
+
+subsection Linear solver
+  set Backend = dealii
+end
+
+subsection Parallelization
+  set Pin threads          = true
+  set Parallel first touch = $touch
+end
+END
+
+  echo "=== parallel first touch $touch, numactl $policy ==="
+  mpirun -np 1 --bind-to none numactl "$policy" \
+    ./step-82 numa_benchmark.prm | sed -n '/^+-/,$p'
+done
+
+rm -f numa_benchmark.prm
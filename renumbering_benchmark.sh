@@ -0,0 +1,32 @@
+#!/bin/sh
+#
+# Compare the numberings of the degrees of freedom: the program is run once
+# with the default numbering of deal.II, which follows the refinement
+# hierarchy, and once with the cells ordered along a Hilbert curve, and the
+# time of the matrix assembly and of a product of the matrix with a vector
+# is printed for each run.
+#
+# Usage: ./renumbering_benchmark.sh [parameter file] [number of MPI processes]
+
+PRM=${1:-step-82.prm}
+RANKS=${2:-1}
+PRODUCTS=50
+
+# Both entries are replaced below, so they must be set in the file.
+if ! grep -q "set DoF ordering" "$PRM" ||
+  ! grep -q "set Number of benchmark products" "$PRM"; then
+  echo "$PRM must set \"DoF ordering\" and \"Number of benchmark products\"" >&2
+  exit 1
+fi
+
+for ordering in default hilbert; do
+  sed -e "s/set DoF ordering *=.*/set DoF ordering = $ordering/" \
+    -e "s/set Number of benchmark products *=.*/set Number of benchmark products = $PRODUCTS/" \
+    "$PRM" > renumbering_benchmark.prm
+
+  echo "=== $RANKS MPI processes, DoF ordering $ordering ==="
+  mpirun -np "$RANKS" ./step-82 renumbering_benchmark.prm |
+    grep -e "Matrix-vector product" -e "| Assemble matrix"
+done
+
+rm -f renumbering_benchmark.prm
@@ -0,0 +1,141 @@
+#!/bin/sh
+#
+# Strong or weak scaling study of all phases of the program. The number of
+# workers, either threads of a single MPI process or MPI processes with one
+# thread each, is increased from 1 up to the given maximum. For strong
+# scaling the problem size is fixed and the number of workers doubles; for
+# weak scaling every step refines the mesh once more and, since this
+# multiplies the number of cells by four in 2d and by eight in 3d, uses four
+# or eight times as many workers. The wall time of every phase, its parallel
+# efficiency relative to the first run and the number of degrees of freedom
+# per second are written to scaling_<mode>_<workers>.csv and
+# scaling_<mode>_<workers>.json. All runs use the same linear algebra
+# backend, by default PETSc, since "auto" would switch from deal.II on one
+# process to PETSc or Trilinos on several, and their solvers differ.
+#
+# Usage: ./scaling_study.sh [strong|weak] [threads|processes]
+#                           [parameter file] [maximal number of workers]
+#                           [dealii|petsc|trilinos]
+
+MODE=${1:-strong}
+WORKERS=${2:-threads}
+PRM=${3:-step-82.prm}
+MAX=${4:-$(nproc)}
+BACKEND=${5:-petsc}
+
+RUNS=scaling_study_runs.csv
+CSV=scaling_${MODE}_${WORKERS}.csv
+JSON=scaling_${MODE}_${WORKERS}.json
+
+rm -f "$RUNS"
+
+# Entries missing from the parameter file take their default values.
+refinements=$(sed -n 's/^ *set Number of refinements *= *\([0-9]*\).*/\1/p' "$PRM" | tail -n 1)
+refinements=${refinements:-3}
+dimension=$(sed -n 's/^ *set Dimension *= *\([0-9]*\).*/\1/p' "$PRM" | tail -n 1)
+if [ "$dimension" = 3 ]; then
+  children=8
+else
+  children=4
+fi
+
+n=1
+while [ "$n" -le "$MAX" ]; do
+  if [ "$WORKERS" = processes ]; then
+    ranks=$n
+    threads=1
+  else
+    ranks=1
+    threads=$n
+  fi
+
+  # Later entries override earlier ones, so the settings of the run are
+  # appended to the parameter file, whether it contains them or not.
+  cat "$PRM" - > scaling_study.prm <<END
+
+subsection Problem
+  set Number of refinements = $refinements
+end
+
+subsection Linear solver
+  set Backend = $BACKEND
+end
+
+subsection Parallelization
+  set Number of threads per process = $threads
+end
+
+subsection Timing
+  set Timing output file = $RUNS
+end
+END
+
+  echo "=== $ranks MPI processes x $threads threads, $refinements refinements ==="
+  mpirun -np "$ranks" ./step-82 scaling_study.prm > /dev/null || exit 1
+
+  if [ "$MODE" = weak ]; then
+    n=$((n * children))
+    refinements=$((refinements + 1))
+  else
+    n=$((n * 2))
+  fi
+done
+
+if [ ! -s "$RUNS" ]; then
+  echo "No timings were written to $RUNS" >&2
+  exit 1
+fi
+
+# One line per run and phase. The efficiency of a phase is T_1 / (p T_p) for
+# strong scaling and T_1 / T_p for weak scaling, where the first run, with
+# one worker, is the reference.
+awk -F, -v mode="$MODE" -v csv="$CSV" -v json="$JSON" '
+  BEGIN {
+    print "workers,processes,threads,refinements,dofs,phase,wall_time," \
+          "efficiency,dofs_per_second" > csv
+    printf "[" > json
+    separator = "\n"
+  }
+  NR == 1 {
+    for (i = 6; i <= NF; ++i)
+      phase[i] = $i
+    next
+  }
+  {
+    workers = $1 * $2
+    if (NR == 2) {
+      reference_workers = workers
+      for (i = 6; i <= NF; ++i)
+        reference[i] = $i
+    }
+    for (i = 6; i <= NF; ++i) {
+      efficiency = ($i > 0 ? reference[i] / $i : 0)
+      if (mode == "strong")
+        efficiency *= reference_workers / workers
+      rate = ($i > 0 ? $5 / $i : 0)
+
+      print workers "," $1 "," $2 "," $3 "," $5 "," phase[i] "," $i "," \
+            efficiency "," rate > csv
+      printf "%s  {\"workers\": %d, \"processes\": %d, \"threads\": %d, " \
+             "\"refinements\": %d, \"dofs\": %d, \"phase\": \"%s\", " \
+             "\"wall_time\": %g, \"efficiency\": %g, " \
+             "\"dofs_per_second\": %g}",
+             separator, workers, $1, $2, $3, $5, phase[i], $i, efficiency,
+             rate > json
+      separator = ",\n"
+    }
+  }
+  END {
+    print "\n]" > json
+  }' "$RUNS"
+status=$?
+
+rm -f scaling_study.prm "$RUNS"
+
+if [ "$status" -ne 0 ]; then
+  echo "Could not evaluate the timings" >&2
+  rm -f "$CSV" "$JSON"
+  exit 1
+fi
+
+echo "Results written to $CSV and $JSON"
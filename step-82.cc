@@ -16,18 +16,50 @@
  * Authors: Andrea Bonito and Diane Guignard, 2021.
  */
 
+#include <deal.II/base/conditional_ostream.h>
+#include <deal.II/base/graph_coloring.h>
+#include <deal.II/base/index_set.h>
+#include <deal.II/base/mpi.h>
+#include <deal.II/base/multithread_info.h>
+#include <deal.II/base/parallel.h>
+#include <deal.II/base/parameter_handler.h>
+#include <deal.II/base/timer.h>
+#include <deal.II/base/utilities.h>
+#include <deal.II/base/vectorization.h>
+#include <deal.II/base/work_stream.h>
+
+#include <deal.II/distributed/cell_weights.h>
+#include <deal.II/distributed/grid_refinement.h>
+#include <deal.II/distributed/solution_transfer.h>
+#include <deal.II/distributed/tria.h>
+
 #include <deal.II/grid/tria.h>
 #include <deal.II/grid/grid_generator.h>
+#include <deal.II/grid/grid_in.h>
+#include <deal.II/grid/grid_tools.h>
 #include <deal.II/grid/tria_accessor.h>
 #include <deal.II/grid/tria_iterator.h>
+#include <deal.II/grid/filtered_iterator.h>
+#include <deal.II/grid/manifold.h>
 
 #include <deal.II/dofs/dof_handler.h>
+#include <deal.II/dofs/dof_renumbering.h>
 #include <deal.II/dofs/dof_accessor.h>
 #include <deal.II/dofs/dof_tools.h>
 
+#include <deal.II/fe/fe_dgp.h>
 #include <deal.II/fe/fe_dgq.h>
+#include <deal.II/fe/fe_series.h>
 #include <deal.II/fe/fe_values.h>
 #include <deal.II/fe/fe_system.h>
+#include <deal.II/fe/mapping_q_cache.h>
+#include <deal.II/fe/mapping_q_generic.h>
+
+#include <deal.II/hp/fe_collection.h>
+#include <deal.II/hp/fe_values.h>
+#include <deal.II/hp/mapping_collection.h>
+#include <deal.II/hp/q_collection.h>
+#include <deal.II/hp/refinement.h>
 
 #include <deal.II/base/quadrature_lib.h>
 #include <deal.II/base/function.h>
@@ -35,1228 +67,6343 @@
 #include <deal.II/numerics/vector_tools.h>
 #include <deal.II/numerics/matrix_tools.h>
 #include <deal.II/numerics/data_out.h>
+#include <deal.II/numerics/smoothness_estimator.h>
 
 #include <deal.II/lac/vector.h>
+#include <deal.II/lac/la_parallel_vector.h>
 #include <deal.II/lac/full_matrix.h>
 #include <deal.II/lac/sparse_matrix.h>
 #include <deal.II/lac/dynamic_sparsity_pattern.h>
+#include <deal.II/lac/sparsity_tools.h>
 #include <deal.II/lac/sparse_direct.h>
 #include <deal.II/lac/solver_cg.h>
 #include <deal.II/lac/precondition.h>
-
+#include <deal.II/lac/petsc_sparse_matrix.h>
+#include <deal.II/lac/petsc_vector.h>
+#include <deal.II/lac/petsc_solver.h>
+#include <deal.II/lac/petsc_precondition.h>
+#include <deal.II/lac/trilinos_sparse_matrix.h>
+#include <deal.II/lac/trilinos_vector.h>
+#include <deal.II/lac/trilinos_solver.h>
+#include <deal.II/lac/trilinos_precondition.h>
+
+#include <boost/serialization/string.hpp>
+#include <boost/serialization/utility.hpp>
+#include <boost/serialization/vector.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
 #include <fstream>
+#include <functional>
+#include <iomanip>
 #include <iostream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <shared_mutex>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+// Worker threads can only be pinned to cores if they are TBB threads and
+// the operating system lets us set their affinity.
+#if defined(DEAL_II_WITH_TBB) && defined(__linux__)
+#  include <tbb/task_scheduler_observer.h>
+
+#  include <sched.h>
+
+#  define STEP82_WITH_THREAD_PINNING
+#endif
+
+
+// The PETSc backend is only available for real-valued PETSc builds.
+#if defined(DEAL_II_WITH_PETSC) && !defined(DEAL_II_PETSC_WITH_COMPLEX)
+#  define STEP82_WITH_PETSC
+#endif
+
+// The backend used if the parameter file asks for "auto". It can be set
+// when configuring the program, see CMakeLists.txt.
+#ifndef STEP82_DEFAULT_BACKEND
+#  define STEP82_DEFAULT_BACKEND "auto"
+#endif
 
 
 namespace Step82
 {
   using namespace dealii;
 
-  template <int dim>
-  class BiLaplacianLDGLift
+  // The run time parameters of the program. They are read from the
+  // parameter file given on the command line; if no file is given, the
+  // default values declared below are used.
+  struct Parameters
   {
-  public:
-    BiLaplacianLDGLift(const unsigned int n_refinements,
-                       const unsigned int fe_degree,
-                       const double       penalty_jump_grad,
-                       const double       penalty_jump_val);
-
-    void run();
+    static void declare_parameters(ParameterHandler &prm);
+    void        parse_parameters(ParameterHandler &prm);
+
+    std::string  run_mode;
+    unsigned int dimension;
+
+    std::string  mesh_file;
+    std::string  cell_ordering;
+    unsigned int n_refinements;
+    std::string  polynomial_space;
+    unsigned int fe_degree;
+    double       penalty_jump_grad;
+    double       penalty_jump_val;
+    double       mesh_distortion;
+    unsigned int mapping_degree;
+
+    unsigned int n_cycles;
+    std::string  refinement;
+    unsigned int max_fe_degree;
+    double       refine_fraction;
+    double       coarsen_fraction;
+    bool         incremental_assembly;
+
+    std::string  linear_algebra_backend;
+    std::string  solver;
+    double       solver_tolerance;
+    unsigned int solver_max_iterations;
+
+    unsigned int n_threads;
+    bool         pin_threads;
+    bool         parallel_first_touch;
+    bool         deterministic;
+    bool         overlap_communication;
+    std::string  assembly_schedule;
+    std::string  dof_ordering;
+    unsigned int n_benchmark_products;
+
+    std::string cell_cost_model;
+    std::string cell_cost_input_file;
+    std::string cell_cost_output_file;
+
+    std::string  output_format;
+    std::string  output_files;
+    std::string  output_compression;
+    bool         high_order_output;
+    bool         asynchronous_output;
+    unsigned int output_queue_length;
+
+    std::string timing_output_file;
+
+    std::string batch_file;
+    std::string batch_output_file;
+
+    unsigned int              convergence_min_refinements;
+    unsigned int              convergence_max_refinements;
+    std::vector<unsigned int> convergence_degrees;
+    std::string               convergence_output_file;
+    std::string               convergence_output_format;
+  };
 
-  private:
-    void make_grid();
-    void setup_system();
-    void assemble_system();
-    void assemble_matrix();
-    void assemble_rhs();
 
-    void solve();
 
-    void compute_errors();
-    void output_results() const;
+  void Parameters::declare_parameters(ParameterHandler &prm)
+  {
+    prm.declare_entry("Run mode",
+                      "single",
+                      Patterns::Selection("single|batch|convergence"),
+                      "Solve the problem described by this file, all "
+                      "problems listed in the batch file (see the "
+                      "subsection 'Batch'), or the problem on a sequence of "
+                      "meshes for several degrees (see the subsection "
+                      "'Convergence study')");
+    prm.declare_entry("Dimension",
+                      "2",
+                      Patterns::Integer(2, 3),
+                      "Space dimension of the problem, on the unit square "
+                      "or the unit cube");
+
+    prm.enter_subsection("Problem");
+    {
+      prm.declare_entry("Mesh file",
+                        "",
+                        Patterns::Anything(),
+                        "Coarse mesh in one of the formats of GridIn (e.g. "
+                        ".msh or .inp), read instead of the unit square or "
+                        "cube. The errors are only meaningful if it covers "
+                        "the unit square or cube.");
+      prm.declare_entry("Cell ordering",
+                        "cuthill_mckee",
+                        Patterns::Selection("none|cuthill_mckee|hierarchical"),
+                        "Order of the cells of the mesh file: as in the "
+                        "file, or renumbered such that neighboring cells "
+                        "have close indices");
+      prm.declare_entry("Number of refinements",
+                        "3",
+                        Patterns::Integer(0),
+                        "Number of global refinements of the initial mesh");
+      prm.declare_entry("Polynomial space",
+                        "Q",
+                        Patterns::Selection("Q|P"),
+                        "Polynomials of the given degree in each variable "
+                        "(FE_DGQ), or of the given total degree (FE_DGP), "
+                        "for u_h and the two lifting terms. P has the same "
+                        "order of convergence with far fewer degrees of "
+                        "freedom per cell.");
+      prm.declare_entry("Polynomial degree",
+                        "2",
+                        Patterns::Integer(2),
+                        "FE degree for u_h and the two lifting terms");
+      prm.declare_entry("Penalty jump gradient",
+                        "1.0",
+                        Patterns::Double(0.0),
+                        "Penalty coefficient for the jump of the gradients");
+      prm.declare_entry("Penalty jump value",
+                        "1.0",
+                        Patterns::Double(0.0),
+                        "Penalty coefficient for the jump of the values");
+      prm.declare_entry("Mesh distortion",
+                        "0.0",
+                        Patterns::Double(0.0, 0.1),
+                        "Amplitude of a smooth deformation of the interior "
+                        "of the domain, which makes the cells curved. 0 "
+                        "keeps the cells rectangular.");
+      prm.declare_entry("Mapping degree",
+                        "1",
+                        Patterns::Integer(1),
+                        "Polynomial degree of the mapping from the reference "
+                        "cell, which describes curved cells better the "
+                        "higher it is");
+    }
+    prm.leave_subsection();
 
-    void assemble_local_matrix(const FEValues<dim> &fe_values_lift,
-                               const unsigned int   n_q_points,
-                               FullMatrix<double> & local_matrix);
+    prm.enter_subsection("Mesh refinement");
+    {
+      prm.declare_entry("Number of cycles",
+                        "1",
+                        Patterns::Integer(1),
+                        "Number of times the problem is solved. The mesh is "
+                        "refined after every cycle but the last, and the "
+                        "solution is transferred to the new mesh as the "
+                        "initial guess of the iterative solver.");
+      prm.declare_entry("Refinement",
+                        "global",
+                        Patterns::Selection("global|adaptive|hp"),
+                        "Refine all cells, or the cells with the largest "
+                        "error indicators. 'hp' raises the polynomial "
+                        "degree instead of splitting those of these cells "
+                        "on which the solution is smooth.");
+      prm.declare_entry("Maximal polynomial degree",
+                        "0",
+                        Patterns::Integer(0),
+                        "Largest polynomial degree of the cells in hp "
+                        "refinement. 0 is the polynomial degree of the "
+                        "initial mesh, i.e. no p-refinement.");
+      prm.declare_entry("Refine fraction",
+                        "0.3",
+                        Patterns::Double(0.0, 1.0),
+                        "Fraction of the cells refined in adaptive "
+                        "refinement");
+      prm.declare_entry("Coarsen fraction",
+                        "0.0",
+                        Patterns::Double(0.0, 1.0),
+                        "Fraction of the cells coarsened in adaptive "
+                        "refinement");
+      prm.declare_entry("Incremental assembly",
+                        "false",
+                        Patterns::Bool(),
+                        "Copy the rows of the matrix of the cells all of "
+                        "whose neighbors up to two faces away did not change "
+                        "in the refinement from the previous matrix, and "
+                        "the right hand side of the unchanged cells, "
+                        "instead of computing them again.");
+    }
+    prm.leave_subsection();
 
-    void compute_discrete_hessians(
-      const typename DoFHandler<dim>::active_cell_iterator &cell,
-      std::vector<std::vector<Tensor<2, dim>>> &            discrete_hessians,
-      std::vector<std::vector<std::vector<Tensor<2, dim>>>>
-        &discrete_hessians_neigh);
+    prm.enter_subsection("Linear solver");
+    {
+      prm.declare_entry("Backend",
+                        STEP82_DEFAULT_BACKEND,
+                        Patterns::Selection("auto|dealii|petsc|trilinos"),
+                        "Library providing the matrix, the vectors and the "
+                        "solvers. 'auto' uses deal.II on a single process and "
+                        "PETSc (or Trilinos if PETSc is not available) "
+                        "otherwise.");
+      prm.declare_entry("Solver",
+                        "direct",
+                        Patterns::Selection("direct|cg"),
+                        "Sparse direct solver of the backend, or conjugate "
+                        "gradients preconditioned by SSOR (deal.II) or "
+                        "algebraic multigrid (PETSc, Trilinos)");
+      prm.declare_entry("Tolerance",
+                        "1e-12",
+                        Patterns::Double(0.0),
+                        "Relative tolerance of the iterative solver");
+      prm.declare_entry("Maximal number of iterations",
+                        "10000",
+                        Patterns::Integer(1));
+    }
+    prm.leave_subsection();
 
-    Triangulation<dim> triangulation;
+    prm.enter_subsection("Parallelization");
+    {
+      prm.declare_entry("Number of threads per process",
+                        "0",
+                        Patterns::Integer(0),
+                        "Number of threads used by each MPI process for the "
+                        "loops over the cells. 0 shares the cores of each "
+                        "node evenly between the MPI processes running on "
+                        "it.");
+      prm.declare_entry("Pin threads",
+                        "false",
+                        Patterns::Bool(),
+                        "Bind every thread to one of the cores the MPI "
+                        "process may run on, so that the memory it touches "
+                        "first stays on its NUMA domain");
+      prm.declare_entry("Parallel first touch",
+                        "true",
+                        Patterns::Bool(),
+                        "Zero the vectors of the deal.II backend on all "
+                        "threads, so that their pages are spread over the "
+                        "NUMA domains of the threads, instead of on the main "
+                        "thread, which places all of them on its domain");
+      prm.declare_entry("Deterministic",
+                        "false",
+                        Patterns::Bool(),
+                        "Add up the contributions of the cells in a fixed "
+                        "order, so that repeated runs with the same number "
+                        "of processes give bitwise identical results, "
+                        "whatever the number of threads.");
+      prm.declare_entry("Overlap communication",
+                        "true",
+                        Patterns::Bool(),
+                        "Work on the cells away from other processes while "
+                        "the matrix entries and the values of the solution "
+                        "needed by other processes are being sent. This "
+                        "applies to the assembly and the computation of the "
+                        "errors; the matrix-vector products of the solvers "
+                        "are those of the linear algebra library.");
+      prm.declare_entry("Assembly schedule",
+                        "chunks",
+                        Patterns::Selection("chunks|colored"),
+                        "Hand chunks of cells to the threads and add their "
+                        "contributions to the matrix one chunk after the "
+                        "other, or color the cells such that all cells of "
+                        "one color can add their contributions at the same "
+                        "time. The colors need the deal.II backend, which "
+                        "runs on a single process; with the other backends, "
+                        "the chunks are used instead, with a warning.");
+      prm.declare_entry("DoF ordering",
+                        "default",
+                        Patterns::Selection("default|hilbert"),
+                        "Number the degrees of freedom of every process in "
+                        "the order of the refinement hierarchy, or cell by "
+                        "cell along a Hilbert curve through the cells");
+      prm.declare_entry("Number of benchmark products",
+                        "0",
+                        Patterns::Integer(0),
+                        "Number of products of the matrix with a vector "
+                        "timed after every assembly, to compare the DoF "
+                        "orderings. 0 skips this benchmark.");
+    }
+    prm.leave_subsection();
 
-    const unsigned int n_refinements;
+    prm.enter_subsection("Load balancing");
+    {
+      prm.declare_entry("Cell cost model",
+                        "model",
+                        Patterns::Selection("uniform|model|measured"),
+                        "Cost of a cell used to distribute the cells between "
+                        "the MPI processes and the threads: the same for all "
+                        "cells, estimated from the number of interior faces "
+                        "of the cell, or the assembly times measured in a "
+                        "previous run (see 'Cell cost input file')");
+      prm.declare_entry("Cell cost input file",
+                        "cell_costs.txt",
+                        Patterns::Anything(),
+                        "File with the measured cell costs read if the cell "
+                        "cost model is 'measured'");
+      prm.declare_entry("Cell cost output file",
+                        "",
+                        Patterns::Anything(),
+                        "If not empty, the assembly time of every cell is "
+                        "written to this file");
+    }
+    prm.leave_subsection();
 
-    FE_DGQ<dim>     fe;
-    DoFHandler<dim> dof_handler;
+    prm.enter_subsection("Output");
+    {
+      prm.declare_entry("Output format",
+                        "vtu",
+                        Patterns::Selection("vtu|hdf5"),
+                        "Format of the solution written in every cycle: "
+                        "binary VTU, or HDF5 with an XDMF description (only "
+                        "if deal.II was configured with HDF5)");
+      prm.declare_entry("Output files",
+                        "per_process",
+                        Patterns::Selection("per_process|single"),
+                        "Write one VTU file per process, tied together by a "
+                        "PVTU record, or a single VTU file with MPI I/O. "
+                        "HDF5 output is always a single file.");
+      prm.declare_entry("Compression",
+                        "best_speed",
+                        Patterns::Selection(
+                          "none|best_speed|default|best_compression"),
+                        "zlib compression level of the VTU files");
+      prm.declare_entry("High-order cells",
+                        "false",
+                        Patterns::Bool(),
+                        "Write every cell of the VTU files as one Lagrange "
+                        "cell of the degree of the solution, instead of "
+                        "subdividing it into linear cells");
+      prm.declare_entry("Asynchronous output",
+                        "true",
+                        Patterns::Bool(),
+                        "Write the files of every process and the sparsity "
+                        "pattern in a background thread while the program "
+                        "goes on with the next cycle. Single VTU files and "
+                        "HDF5 files are written by all processes together "
+                        "and always synchronously.");
+      prm.declare_entry("Output queue length",
+                        "2",
+                        Patterns::Integer(1),
+                        "Number of outputs that may wait for the background "
+                        "thread before the program waits for it");
+    }
+    prm.leave_subsection();
 
-    FESystem<dim> fe_lift;
+    prm.enter_subsection("Timing");
+    {
+      prm.declare_entry("Timing output file",
+                        "",
+                        Patterns::Anything(),
+                        "If not empty, one line with the number of processes "
+                        "and threads, the size of the problem and the wall "
+                        "time of every phase is appended to this CSV file");
+    }
+    prm.leave_subsection();
 
-    SparsityPattern      sparsity_pattern;
-    SparseMatrix<double> matrix;
-    Vector<double>       rhs;
-    Vector<double>       solution;
+    prm.enter_subsection("Batch");
+    {
+      prm.declare_entry("Batch file",
+                        "batch.txt",
+                        Patterns::Anything(),
+                        "List of problems solved in the batch run mode, one "
+                        "per line: number of refinements, polynomial degree, "
+                        "penalty coefficients for the jumps of the gradients "
+                        "and of the values. All other parameters are taken "
+                        "from this file.");
+      prm.declare_entry("Batch output file",
+                        "batch_results.csv",
+                        Patterns::Anything(),
+                        "CSV file to which the size, the errors and the wall "
+                        "time of every problem of the batch are written");
+    }
+    prm.leave_subsection();
 
-    const double penalty_jump_grad;
-    const double penalty_jump_val;
-  };
+    prm.enter_subsection("Convergence study");
+    {
+      prm.declare_entry("Minimal number of refinements",
+                        "2",
+                        Patterns::Integer(0),
+                        "Number of global refinements of the first mesh of "
+                        "the study");
+      prm.declare_entry("Maximal number of refinements",
+                        "6",
+                        Patterns::Integer(0),
+                        "Number of global refinements of the last mesh of "
+                        "the study");
+      prm.declare_entry("Polynomial degrees",
+                        "2, 3, 4, 5",
+                        Patterns::List(Patterns::Integer(2)),
+                        "Polynomial degrees for which the study is run");
+      prm.declare_entry("Output file",
+                        "convergence.csv",
+                        Patterns::Anything(),
+                        "File to which the size, the errors, the orders of "
+                        "convergence and the wall time of every phase on "
+                        "every mesh of the study are written");
+      prm.declare_entry("Output format",
+                        "csv",
+                        Patterns::Selection("csv|json"),
+                        "Format of the output file");
+    }
+    prm.leave_subsection();
+  }
 
 
 
-  template <int dim>
-  class RightHandSide : public Function<dim>
+  void Parameters::parse_parameters(ParameterHandler &prm)
   {
-  public:
-    RightHandSide()
-      : Function<dim>()
-    {}
+    run_mode  = prm.get("Run mode");
+    dimension = prm.get_integer("Dimension");
 
-    virtual double value(const Point<dim> & p,
-                         const unsigned int component = 0) const override;
-  };
+    prm.enter_subsection("Problem");
+    {
+      mesh_file         = prm.get("Mesh file");
+      cell_ordering     = prm.get("Cell ordering");
+      n_refinements     = prm.get_integer("Number of refinements");
+      polynomial_space  = prm.get("Polynomial space");
+      fe_degree         = prm.get_integer("Polynomial degree");
+      penalty_jump_grad = prm.get_double("Penalty jump gradient");
+      penalty_jump_val  = prm.get_double("Penalty jump value");
+      mesh_distortion   = prm.get_double("Mesh distortion");
+      mapping_degree    = prm.get_integer("Mapping degree");
+    }
+    prm.leave_subsection();
 
+    prm.enter_subsection("Mesh refinement");
+    {
+      n_cycles             = prm.get_integer("Number of cycles");
+      refinement           = prm.get("Refinement");
+      max_fe_degree        = prm.get_integer("Maximal polynomial degree");
+      refine_fraction      = prm.get_double("Refine fraction");
+      coarsen_fraction     = prm.get_double("Coarsen fraction");
+      incremental_assembly = prm.get_bool("Incremental assembly");
+    }
+    prm.leave_subsection();
 
+    prm.enter_subsection("Linear solver");
+    {
+      linear_algebra_backend = prm.get("Backend");
+      solver                 = prm.get("Solver");
+      solver_tolerance       = prm.get_double("Tolerance");
+      solver_max_iterations  = prm.get_integer("Maximal number of iterations");
+    }
+    prm.leave_subsection();
 
-  template <int dim>
-  double RightHandSide<dim>::value(const Point<dim> &p,
-                                   const unsigned int /*component*/) const
-  {
-    double return_value = 0.0;
+    prm.enter_subsection("Parallelization");
+    {
+      n_threads             = prm.get_integer("Number of threads per process");
+      pin_threads           = prm.get_bool("Pin threads");
+      parallel_first_touch  = prm.get_bool("Parallel first touch");
+      deterministic         = prm.get_bool("Deterministic");
+      overlap_communication = prm.get_bool("Overlap communication");
+      assembly_schedule     = prm.get("Assembly schedule");
+      dof_ordering          = prm.get("DoF ordering");
+      n_benchmark_products  = prm.get_integer("Number of benchmark products");
+    }
+    prm.leave_subsection();
 
-    if (dim == 2)
-      {
-        return_value = 24.0 * std::pow(p(1) * (1.0 - p(1)), 2) +
-                       +24.0 * std::pow(p(0) * (1.0 - p(0)), 2) +
-                       2.0 * (2.0 - 12.0 * p(0) + 12.0 * p(0) * p(0)) *
-                         (2.0 - 12.0 * p(1) + 12.0 * p(1) * p(1));
-      }
-    else if (dim == 3)
-      {
-        return_value =
-          24.0 * std::pow(p(1) * (1.0 - p(1)) * p(2) * (1.0 - p(2)), 2) +
-          24.0 * std::pow(p(0) * (1.0 - p(0)) * p(2) * (1.0 - p(2)), 2) +
-          24.0 * std::pow(p(0) * (1.0 - p(0)) * p(1) * (1.0 - p(1)), 2) +
-          2.0 * (2.0 - 12.0 * p(0) + 12.0 * p(0) * p(0)) *
-            (2.0 - 12.0 * p(1) + 12.0 * p(1) * p(1)) *
-            std::pow(p(2) * (1.0 - p(2)), 2) +
-          2.0 * (2.0 - 12.0 * p(0) + 12.0 * p(0) * p(0)) *
-            (2.0 - 12.0 * p(2) + 12.0 * p(2) * p(2)) *
-            std::pow(p(1) * (1.0 - p(1)), 2) +
-          2.0 * (2.0 - 12.0 * p(1) + 12.0 * p(1) * p(1)) *
-            (2.0 - 12.0 * p(2) + 12.0 * p(2) * p(2)) *
-            std::pow(p(0) * (1.0 - p(0)), 2);
-      }
-    else
-      Assert(false, ExcNotImplemented());
+    prm.enter_subsection("Load balancing");
+    {
+      cell_cost_model       = prm.get("Cell cost model");
+      cell_cost_input_file  = prm.get("Cell cost input file");
+      cell_cost_output_file = prm.get("Cell cost output file");
+    }
+    prm.leave_subsection();
 
-    return return_value;
-  }
+    prm.enter_subsection("Output");
+    {
+      output_format       = prm.get("Output format");
+      output_files        = prm.get("Output files");
+      output_compression  = prm.get("Compression");
+      high_order_output   = prm.get_bool("High-order cells");
+      asynchronous_output = prm.get_bool("Asynchronous output");
+      output_queue_length = prm.get_integer("Output queue length");
+    }
+    prm.leave_subsection();
 
+    prm.enter_subsection("Timing");
+    {
+      timing_output_file = prm.get("Timing output file");
+    }
+    prm.leave_subsection();
 
+    prm.enter_subsection("Batch");
+    {
+      batch_file        = prm.get("Batch file");
+      batch_output_file = prm.get("Batch output file");
+    }
+    prm.leave_subsection();
 
-  template <int dim>
-  class ExactSolution : public Function<dim>
-  {
-  public:
-    ExactSolution()
-      : Function<dim>()
-    {}
+    prm.enter_subsection("Convergence study");
+    {
+      convergence_min_refinements =
+        prm.get_integer("Minimal number of refinements");
+      convergence_max_refinements =
+        prm.get_integer("Maximal number of refinements");
+      convergence_degrees.clear();
+      for (const int degree : Utilities::string_to_int(
+             Utilities::split_string_list(prm.get("Polynomial degrees"))))
+        convergence_degrees.push_back(degree);
+      convergence_output_file   = prm.get("Output file");
+      convergence_output_format = prm.get("Output format");
+    }
+    prm.leave_subsection();
+  }
 
-    virtual double value(const Point<dim> & p,
-                         const unsigned int component = 0) const override;
 
-    virtual Tensor<1, dim>
-    gradient(const Point<dim> & p,
-             const unsigned int component = 0) const override;
 
-    virtual SymmetricTensor<2, dim>
-    hessian(const Point<dim> & p,
-            const unsigned int component = 0) const override;
-  };
+  // The linear algebra backends. Each of them provides the matrix and vector
+  // types used by BiLaplacianLDGLift, together with the few operations whose
+  // interface differs between the libraries: the initialization of the
+  // matrix and of the vectors, and the solution of the linear system. All
+  // other operations (adding local contributions, compressing, copying into
+  // ghosted vectors) have the same interface in all three libraries.
+  // threaded_first_touch tells whether the entries of the vectors are left
+  // untouched by reinit_vector(), so that BiLaplacianLDGLift can zero them
+  // on all threads, see first_touch(), and concurrent_add whether
+  // several threads may add to different rows of the matrix at the same
+  // time.
+  namespace LinearAlgebraBackends
+  {
+    struct DealII
+    {
+      using SparseMatrix = dealii::SparseMatrix<double>;
+      using Vector       = dealii::Vector<double>;
 
+      static constexpr bool threaded_first_touch = true;
+      static constexpr bool concurrent_add       = true;
 
+      static void reinit_matrix(SparseMatrix &    matrix,
+                                SparsityPattern & sparsity_pattern,
+                                const IndexSet & /*locally_owned*/,
+                                const DynamicSparsityPattern &dsp,
+                                const MPI_Comm &              communicator)
+      {
+        AssertThrow(Utilities::MPI::n_mpi_processes(communicator) == 1,
+                    ExcMessage("The deal.II linear algebra backend can only "
+                               "be used with a single MPI process."));
 
-  template <int dim>
-  double ExactSolution<dim>::value(const Point<dim> &p,
-                                   const unsigned int /*component*/) const
-  {
-    double return_value = 0.0;
+        sparsity_pattern.copy_from(dsp);
+        matrix.reinit(sparsity_pattern);
+      }
 
-    if (dim == 2)
+      static void reinit_vector(Vector &        vector,
+                                const IndexSet &locally_owned,
+                                const IndexSet & /*locally_relevant*/,
+                                const MPI_Comm & /*communicator*/)
       {
-        return_value = std::pow(p(0) * (1.0 - p(0)) * p(1) * (1.0 - p(1)), 2);
+        vector.reinit(locally_owned.size(), /*omit_zeroing_entries=*/true);
       }
-    else if (dim == 3)
+
+      static unsigned int solve(const Parameters &  parameters,
+                                const SparseMatrix &matrix,
+                                Vector &            solution,
+                                const Vector &      rhs,
+                                const MPI_Comm & /*communicator*/)
       {
-        return_value = std::pow(p(0) * (1.0 - p(0)) * p(1) * (1.0 - p(1)) *
-                                  p(2) * (1.0 - p(2)),
-                                2);
+        if (parameters.solver == "direct")
+          {
+            SparseDirectUMFPACK A_direct;
+            A_direct.initialize(matrix);
+            A_direct.vmult(solution, rhs);
+            return 0;
+          }
+
+        SolverControl solver_control(parameters.solver_max_iterations,
+                                     parameters.solver_tolerance *
+                                       rhs.l2_norm());
+        SolverCG<Vector> solver(solver_control);
+
+        PreconditionSSOR<SparseMatrix> preconditioner;
+        preconditioner.initialize(matrix, 1.2);
+
+        solver.solve(matrix, solution, rhs, preconditioner);
+        return solver_control.last_step();
       }
-    else
-      Assert(false, ExcNotImplemented());
+    };
 
-    return return_value;
-  }
 
 
+#ifdef STEP82_WITH_PETSC
+    struct PETSc
+    {
+      using SparseMatrix = PETScWrappers::MPI::SparseMatrix;
+      using Vector       = PETScWrappers::MPI::Vector;
 
-  template <int dim>
-  Tensor<1, dim>
-  ExactSolution<dim>::gradient(const Point<dim> &p,
-                               const unsigned int /*component*/) const
-  {
-    Tensor<1, dim> return_gradient;
+      static constexpr bool threaded_first_touch = false;
+      static constexpr bool concurrent_add       = false;
 
-    if (dim == 2)
+      static void reinit_matrix(SparseMatrix &matrix,
+                                SparsityPattern & /*sparsity_pattern*/,
+                                const IndexSet &              locally_owned,
+                                const DynamicSparsityPattern &dsp,
+                                const MPI_Comm &              communicator)
       {
-        return_gradient[0] =
-          (2.0 * p(0) - 6.0 * std::pow(p(0), 2) + 4.0 * std::pow(p(0), 3)) *
-          std::pow(p(1) * (1.0 - p(1)), 2);
-        return_gradient[1] =
-          (2.0 * p(1) - 6.0 * std::pow(p(1), 2) + 4.0 * std::pow(p(1), 3)) *
-          std::pow(p(0) * (1.0 - p(0)), 2);
+        matrix.reinit(locally_owned, locally_owned, dsp, communicator);
       }
-    else if (dim == 3)
+
+      static void reinit_vector(Vector &        vector,
+                                const IndexSet &locally_owned,
+                                const IndexSet &locally_relevant,
+                                const MPI_Comm &communicator)
       {
-        return_gradient[0] =
-          (2.0 * p(0) - 6.0 * std::pow(p(0), 2) + 4.0 * std::pow(p(0), 3)) *
-          std::pow(p(1) * (1.0 - p(1)) * p(2) * (1.0 - p(2)), 2);
-        return_gradient[1] =
-          (2.0 * p(1) - 6.0 * std::pow(p(1), 2) + 4.0 * std::pow(p(1), 3)) *
-          std::pow(p(0) * (1.0 - p(0)) * p(2) * (1.0 - p(2)), 2);
-        return_gradient[2] =
-          (2.0 * p(2) - 6.0 * std::pow(p(2), 2) + 4.0 * std::pow(p(2), 3)) *
-          std::pow(p(0) * (1.0 - p(0)) * p(1) * (1.0 - p(1)), 2);
+        if (locally_relevant.size() == 0)
+          vector.reinit(locally_owned, communicator);
+        else
+          vector.reinit(locally_owned, locally_relevant, communicator);
       }
-    else
-      Assert(false, ExcNotImplemented());
 
-    return return_gradient;
-  }
+      static unsigned int solve(const Parameters &  parameters,
+                                const SparseMatrix &matrix,
+                                Vector &            solution,
+                                const Vector &      rhs,
+                                const MPI_Comm &    communicator)
+      {
+        if (parameters.solver == "direct")
+          {
+            SolverControl                    solver_control;
+            PETScWrappers::SparseDirectMUMPS solver(solver_control,
+                                                    communicator);
+            solver.set_symmetric_mode(true);
+            solver.solve(matrix, solution, rhs);
+            return 0;
+          }
 
+        SolverControl solver_control(parameters.solver_max_iterations,
+                                     parameters.solver_tolerance *
+                                       rhs.l2_norm());
+        SolverCG<Vector> solver(solver_control);
 
+        PETScWrappers::PreconditionBoomerAMG::AdditionalData data;
+        data.symmetric_operator = true;
+        PETScWrappers::PreconditionBoomerAMG preconditioner(matrix, data);
 
-  template <int dim>
-  SymmetricTensor<2, dim>
-  ExactSolution<dim>::hessian(const Point<dim> &p,
-                              const unsigned int /*component*/) const
-  {
-    SymmetricTensor<2, dim> return_hessian;
-
-    if (dim == 2)
-      {
-        return_hessian[0][0] = (2.0 - 12.0 * p(0) + 12.0 * p(0) * p(0)) *
-                               std::pow(p(1) * (1.0 - p(1)), 2);
-        return_hessian[0][1] =
-          (2.0 * p(0) - 6.0 * std::pow(p(0), 2) + 4.0 * std::pow(p(0), 3)) *
-          (2.0 * p(1) - 6.0 * std::pow(p(1), 2) + 4.0 * std::pow(p(1), 3));
-        return_hessian[1][1] = (2.0 - 12.0 * p(1) + 12.0 * p(1) * p(1)) *
-                               std::pow(p(0) * (1.0 - p(0)), 2);
-      }
-    else if (dim == 3)
-      {
-        return_hessian[0][0] =
-          (2.0 - 12.0 * p(0) + 12.0 * p(0) * p(0)) *
-          std::pow(p(1) * (1.0 - p(1)) * p(2) * (1.0 - p(2)), 2);
-        return_hessian[0][1] =
-          (2.0 * p(0) - 6.0 * std::pow(p(0), 2) + 4.0 * std::pow(p(0), 3)) *
-          (2.0 * p(1) - 6.0 * std::pow(p(1), 2) + 4.0 * std::pow(p(1), 3)) *
-          std::pow(p(2) * (1.0 - p(2)), 2);
-        return_hessian[0][2] =
-          (2.0 * p(0) - 6.0 * std::pow(p(0), 2) + 4.0 * std::pow(p(0), 3)) *
-          (2.0 * p(2) - 6.0 * std::pow(p(2), 2) + 4.0 * std::pow(p(2), 3)) *
-          std::pow(p(1) * (1.0 - p(1)), 2);
-        return_hessian[1][1] =
-          (2.0 - 12.0 * p(1) + 12.0 * p(1) * p(1)) *
-          std::pow(p(0) * (1.0 - p(0)) * p(2) * (1.0 - p(2)), 2);
-        return_hessian[1][2] =
-          (2.0 * p(1) - 6.0 * std::pow(p(1), 2) + 4.0 * std::pow(p(1), 3)) *
-          (2.0 * p(2) - 6.0 * std::pow(p(2), 2) + 4.0 * std::pow(p(2), 3)) *
-          std::pow(p(0) * (1.0 - p(0)), 2);
-        return_hessian[2][2] =
-          (2.0 - 12.0 * p(2) + 12.0 * p(2) * p(2)) *
-          std::pow(p(0) * (1.0 - p(0)) * p(1) * (1.0 - p(1)), 2);
+        solver.solve(matrix, solution, rhs, preconditioner);
+        return solver_control.last_step();
       }
-    else
-      Assert(false, ExcNotImplemented());
+    };
+#endif
 
-    return return_hessian;
-  }
 
 
+#ifdef DEAL_II_WITH_TRILINOS
+    struct Trilinos
+    {
+      using SparseMatrix = TrilinosWrappers::SparseMatrix;
+      using Vector       = TrilinosWrappers::MPI::Vector;
 
-  template <int dim>
-  BiLaplacianLDGLift<dim>::BiLaplacianLDGLift(const unsigned int n_refinements,
-                                              const unsigned int fe_degree,
-                                              const double penalty_jump_grad,
-                                              const double penalty_jump_val)
-    : n_refinements(n_refinements)
-    , fe(fe_degree)
-    , dof_handler(triangulation)
-    , fe_lift(FE_DGQ<dim>(fe_degree), dim * dim)
-    , penalty_jump_grad(penalty_jump_grad)
-    , penalty_jump_val(penalty_jump_val)
-  {}
+      static constexpr bool threaded_first_touch = false;
+      static constexpr bool concurrent_add       = false;
 
+      static void reinit_matrix(SparseMatrix &matrix,
+                                SparsityPattern & /*sparsity_pattern*/,
+                                const IndexSet &              locally_owned,
+                                const DynamicSparsityPattern &dsp,
+                                const MPI_Comm &              communicator)
+      {
+        matrix.reinit(locally_owned, locally_owned, dsp, communicator);
+      }
 
+      static void reinit_vector(Vector &        vector,
+                                const IndexSet &locally_owned,
+                                const IndexSet &locally_relevant,
+                                const MPI_Comm &communicator)
+      {
+        if (locally_relevant.size() == 0)
+          vector.reinit(locally_owned, communicator);
+        else
+          vector.reinit(locally_owned, locally_relevant, communicator);
+      }
 
-  template <int dim>
-  void BiLaplacianLDGLift<dim>::make_grid()
-  {
-    std::cout << "Building the mesh............." << std::endl;
+      static unsigned int solve(const Parameters &  parameters,
+                                const SparseMatrix &matrix,
+                                Vector &            solution,
+                                const Vector &      rhs,
+                                const MPI_Comm & /*communicator*/)
+      {
+        if (parameters.solver == "direct")
+          {
+            SolverControl                  solver_control;
+            TrilinosWrappers::SolverDirect solver(solver_control);
+            solver.solve(matrix, solution, rhs);
+            return 0;
+          }
 
-    GridGenerator::hyper_cube(triangulation, 0.0, 1.0);
+        SolverControl solver_control(parameters.solver_max_iterations,
+                                     parameters.solver_tolerance *
+                                       rhs.l2_norm());
+        SolverCG<Vector> solver(solver_control);
 
-    triangulation.refine_global(n_refinements);
+        TrilinosWrappers::PreconditionAMG::AdditionalData data;
+        data.elliptic              = true;
+        data.higher_order_elements = true;
+        TrilinosWrappers::PreconditionAMG preconditioner;
+        preconditioner.initialize(matrix, data);
 
-    std::cout << "Number of active cells: " << triangulation.n_active_cells()
-              << std::endl;
-  }
+        solver.solve(matrix, solution, rhs, preconditioner);
+        return solver_control.last_step();
+      }
+    };
+#endif
+  } // namespace LinearAlgebraBackends
 
 
 
+  // A neighbor of a cell across one of its faces. After adaptive refinement
+  // the mesh has hanging nodes, but p4est guarantees that neighboring cells
+  // differ by at most one level. A neighbor is therefore either on the same
+  // level as the cell, or coarser, in which case the face of the cell is
+  // the child neighbor_subface_no of the face neighbor_face_no of the
+  // neighbor, or finer, in which case the face of the cell is refined and
+  // the neighbor is adjacent to its child subface_no. The unused subface
+  // numbers are numbers::invalid_unsigned_int. A cell has one neighbor per
+  // interior face that is not refined and one per child of a refined face.
   template <int dim>
-  void BiLaplacianLDGLift<dim>::setup_system()
+  struct FaceNeighbor
   {
-    dof_handler.distribute_dofs(fe);
+    typename DoFHandler<dim>::active_cell_iterator cell;
 
-    std::cout << "Number of degrees of freedom: " << dof_handler.n_dofs()
-              << std::endl;
+    unsigned int face_no;
+    unsigned int subface_no;
+    unsigned int neighbor_face_no;
+    unsigned int neighbor_subface_no;
+  };
 
-    DynamicSparsityPattern dsp(dof_handler.n_dofs(), dof_handler.n_dofs());
 
-    const auto dofs_per_cell = fe.dofs_per_cell;
 
-    for (const auto &cell : dof_handler.active_cell_iterators())
-      {
-        std::vector<types::global_dof_index> dofs(dofs_per_cell);
-        cell->get_dof_indices(dofs);
+  template <int dim>
+  void get_face_neighbors(
+    const typename DoFHandler<dim>::active_cell_iterator &cell,
+    std::vector<FaceNeighbor<dim>> &                      neighbors)
+  {
+    neighbors.clear();
 
-        for (unsigned int f = 0; f < cell->n_faces(); ++f)
-          if (!cell->face(f)->at_boundary())
+    for (const unsigned int face_no : cell->face_indices())
+      if (!cell->at_boundary(face_no))
+        {
+          const auto face = cell->face(face_no);
+
+          if (face->has_children())
+            for (unsigned int subface_no = 0; subface_no < face->n_children();
+                 ++subface_no)
+              neighbors.push_back(
+                {cell->neighbor_child_on_subface(face_no, subface_no),
+                 face_no,
+                 subface_no,
+                 cell->neighbor_of_neighbor(face_no),
+                 numbers::invalid_unsigned_int});
+          else if (cell->neighbor_is_coarser(face_no))
             {
-              const auto neighbor_cell = cell->neighbor(f);
+              const std::pair<unsigned int, unsigned int> neighbor_face =
+                cell->neighbor_of_coarser_neighbor(face_no);
+              neighbors.push_back({cell->neighbor(face_no),
+                                   face_no,
+                                   numbers::invalid_unsigned_int,
+                                   neighbor_face.first,
+                                   neighbor_face.second});
+            }
+          else
+            neighbors.push_back({cell->neighbor(face_no),
+                                 face_no,
+                                 numbers::invalid_unsigned_int,
+                                 cell->neighbor_of_neighbor(face_no),
+                                 numbers::invalid_unsigned_int});
+        }
+  }
 
-              std::vector<types::global_dof_index> tmp(dofs_per_cell);
-              neighbor_cell->get_dof_indices(tmp);
 
-              dofs.insert(std::end(dofs), std::begin(tmp), std::end(tmp));
-            }
 
-        for (const auto i : dofs)
-          for (const auto j : dofs)
-            {
-              dsp.add(i, j);
-              dsp.add(j, i);
-            }
+  // The cells up to two faces away from a cell, whose DoFs the rows of the
+  // cell couple to: the cell, its face neighbors, and then the neighbors of
+  // each of these, in the order of get_face_neighbors() and without
+  // repetitions. The order only depends on the cells, so it is the same on
+  // a new mesh on which none of these cells has changed. The neighbors of
+  // the cell must not be artificial.
+  template <int dim>
+  void get_two_ring(
+    const typename DoFHandler<dim>::active_cell_iterator &cell,
+    const std::vector<FaceNeighbor<dim>> &                neighbors,
+    std::vector<typename DoFHandler<dim>::active_cell_iterator> &cells)
+  {
+    cells.assign(1, cell);
+    for (const auto &neighbor : neighbors)
+      cells.push_back(neighbor.cell);
+
+    std::vector<FaceNeighbor<dim>> second_neighbors;
+    for (const auto &neighbor : neighbors)
+      {
+        get_face_neighbors<dim>(neighbor.cell, second_neighbors);
+        for (const auto &second_neighbor : second_neighbors)
+          if (std::find(cells.begin(), cells.end(), second_neighbor.cell) ==
+              cells.end())
+            cells.push_back(second_neighbor.cell);
       }
+  }
+
 
-    sparsity_pattern.copy_from(dsp);
 
+  // Add a boundary face of a coarse mesh to the description of its faces,
+  // which keeps the lines of a 2D mesh and the quadrilaterals of a 3D one.
+  void add_boundary_face(SubCellData &subcell_data, const CellData<1> &face)
+  {
+    subcell_data.boundary_lines.push_back(face);
+  }
 
-    matrix.reinit(sparsity_pattern);
-    rhs.reinit(dof_handler.n_dofs());
 
-    solution.reinit(dof_handler.n_dofs());
 
-    std::ofstream out("sparsity_pattern.svg");
-    sparsity_pattern.print_svg(out);
+  void add_boundary_face(SubCellData &subcell_data, const CellData<2> &face)
+  {
+    subcell_data.boundary_quads.push_back(face);
   }
 
 
 
-  template <int dim>
-  void BiLaplacianLDGLift<dim>::assemble_system()
+  // Initialize the values on the given face of a cell, or on one of its
+  // children if subface_no is valid. The values on both sides of the part
+  // of a face two neighbors share are then given at the same points,
+  // provided that both sides use the same quadrature rule q_index, see
+  // face_quadrature_index(). The element fe_index is only needed for cells
+  // of the triangulation, which do not know their active element;
+  // numbers::invalid_unsigned_int takes that of a cell of the DoFHandler.
+  template <int dim, typename CellIterator>
+  const FEFaceValuesBase<dim> &
+  reinit_face_values(const CellIterator &      cell,
+                     const unsigned int        face_no,
+                     const unsigned int        subface_no,
+                     const unsigned int        q_index,
+                     const unsigned int        fe_index,
+                     hp::FEFaceValues<dim> &   fe_face,
+                     hp::FESubfaceValues<dim> &fe_subface)
   {
-    std::cout << "Assembling the system............." << std::endl;
-
-    assemble_matrix();
-    assemble_rhs();
+    if (subface_no == numbers::invalid_unsigned_int)
+      {
+        fe_face.reinit(
+          cell, face_no, q_index, numbers::invalid_unsigned_int, fe_index);
+        return fe_face.get_present_fe_values();
+      }
 
-    std::cout << "Done. " << std::endl;
+    fe_subface.reinit(cell,
+                      face_no,
+                      subface_no,
+                      q_index,
+                      numbers::invalid_unsigned_int,
+                      fe_index);
+    return fe_subface.get_present_fe_values();
   }
 
 
 
+  // The quadrature rule on a face shared by two cells of possibly different
+  // polynomial degrees: the element and quadrature collections are ordered
+  // by degree, and the rule of the higher degree integrates the products of
+  // the shape functions of both sides.
   template <int dim>
-  void BiLaplacianLDGLift<dim>::assemble_matrix()
+  unsigned int face_quadrature_index(
+    const typename DoFHandler<dim>::active_cell_iterator &cell,
+    const typename DoFHandler<dim>::active_cell_iterator &neighbor)
   {
-    matrix = 0;
+    return std::max(cell->active_fe_index(), neighbor->active_fe_index());
+  }
 
-    QGauss<dim>     quad(fe.degree + 1);
-    QGauss<dim - 1> quad_face(fe.degree + 1);
 
-    const unsigned int n_q_points      = quad.size();
-    const unsigned int n_q_points_face = quad_face.size();
 
-    FEValues<dim> fe_values(fe, quad, update_hessians | update_JxW_values);
+  // The scratch and copy data objects of the WorkStream loops over the
+  // locally owned cells, organized as in step-32. Every thread works on its
+  // own copy of the scratch objects, so that no FEValues object or local
+  // matrix is shared or reallocated between cells, and the copy data objects
+  // carry the contributions of one cell to the copier functions, which are
+  // never run concurrently.
+  namespace Assembly
+  {
+    namespace Scratch
+    {
+      // The objects needed to compute the discrete Hessians of the shape
+      // functions of one cell and of its neighbors. The local matrix and
+      // vectors of the lifting are resized to the degree of every cell.
+      template <int dim>
+      struct Lifting
+      {
+        Lifting(const hp::MappingCollection<dim> &mapping,
+                const hp::FECollection<dim> &     fe,
+                const hp::FECollection<dim> &     fe_lift,
+                const hp::QCollection<dim> &      quad,
+                const hp::QCollection<dim - 1> &  quad_face);
+
+        Lifting(const Lifting<dim> &scratch_data);
+
+        hp::FEValues<dim>        fe_values;
+        hp::FEFaceValues<dim>    fe_face;
+        hp::FEFaceValues<dim>    fe_face_neighbor;
+        hp::FESubfaceValues<dim> fe_subface_neighbor;
+
+        hp::FEValues<dim>        fe_values_lift;
+        hp::FEFaceValues<dim>    fe_face_lift;
+        hp::FESubfaceValues<dim> fe_subface_lift;
+
+        // The inverse of the scalar mass matrix of the cell, the right
+        // hand sides of the liftings of all shape functions of one cell (one
+        // per row), and the right hand side and coefficients of one lifting.
+        FullMatrix<double> mass_matrix_inverse;
+        FullMatrix<double> local_rhs;
+
+        Vector<double> rhs_lift, coeffs_lift;
+      };
+
+
+
+      template <int dim>
+      Lifting<dim>::Lifting(const hp::MappingCollection<dim> &mapping,
+                            const hp::FECollection<dim> &     fe,
+                            const hp::FECollection<dim> &     fe_lift,
+                            const hp::QCollection<dim> &      quad,
+                            const hp::QCollection<dim - 1> &  quad_face)
+        : fe_values(mapping,
+                    fe,
+                    quad,
+                    update_values | update_hessians | update_JxW_values)
+        , fe_face(mapping,
+                  fe,
+                  quad_face,
+                  update_values | update_gradients | update_normal_vectors)
+        , fe_face_neighbor(mapping,
+                           fe,
+                           quad_face,
+                           update_values | update_gradients |
+                             update_normal_vectors)
+        , fe_subface_neighbor(mapping,
+                              fe,
+                              quad_face,
+                              update_values | update_gradients |
+                                update_normal_vectors)
+        , fe_values_lift(mapping,
+                         fe_lift,
+                         quad,
+                         update_values | update_JxW_values)
+        , fe_face_lift(mapping,
+                       fe_lift,
+                       quad_face,
+                       update_values | update_gradients | update_JxW_values)
+        , fe_subface_lift(mapping,
+                          fe_lift,
+                          quad_face,
+                          update_values | update_gradients |
+                            update_JxW_values)
+        , mass_matrix_inverse(fe.max_dofs_per_cell(), fe.max_dofs_per_cell())
+        , local_rhs(fe.max_dofs_per_cell(), fe_lift.max_dofs_per_cell())
+        , rhs_lift(fe_lift.max_dofs_per_cell())
+        , coeffs_lift(fe_lift.max_dofs_per_cell())
+      {}
+
+
+
+      template <int dim>
+      Lifting<dim>::Lifting(const Lifting<dim> &scratch_data)
+        : Lifting(scratch_data.fe_values.get_mapping_collection(),
+                  scratch_data.fe_values.get_fe_collection(),
+                  scratch_data.fe_values_lift.get_fe_collection(),
+                  scratch_data.fe_values.get_quadrature_collection(),
+                  scratch_data.fe_face.get_quadrature_collection())
+      {}
+
+
+
+      // The local matrices are resized to the numbers of DoFs of the cells
+      // they couple, which differ between cells of different degrees. The
+      // discrete Hessians are allocated for the largest element and only
+      // the entries of the DoFs and quadrature points of the current cells
+      // are used.
+      template <int dim>
+      struct Matrix
+      {
+        Matrix(const hp::MappingCollection<dim> &mapping,
+               const hp::FECollection<dim> &     fe,
+               const hp::FECollection<dim> &     fe_lift,
+               const hp::QCollection<dim> &      quad,
+               const hp::QCollection<dim - 1> &  quad_face);
+
+        Matrix(const Matrix<dim> &scratch_data);
+
+        hp::FEValues<dim>        fe_values;
+        hp::FEFaceValues<dim>    fe_face;
+        hp::FEFaceValues<dim>    fe_face_neighbor;
+        hp::FESubfaceValues<dim> fe_subface_neighbor;
+
+        Lifting<dim> lifting;
+
+        std::vector<FaceNeighbor<dim>> neighbors;
+
+        std::vector<types::global_dof_index> local_dof_indices;
+        std::vector<types::global_dof_index> local_dof_indices_neighbor;
+        std::vector<types::global_dof_index> local_dof_indices_neighbor_2;
+
+        FullMatrix<double> stiffness_matrix_cc; // interactions cell / cell
+        FullMatrix<double> stiffness_matrix_cn; // interactions cell / neighbor
+        FullMatrix<double> stiffness_matrix_nc; // interactions neighbor / cell
+        FullMatrix<double>
+          stiffness_matrix_nn; // interactions neighbor / neighbor
+        FullMatrix<double>
+          stiffness_matrix_n1n2; // interactions neighbor1 / neighbor2
+        FullMatrix<double>
+          stiffness_matrix_n2n1; // interactions neighbor2 / neighbor1
+
+        FullMatrix<double> ip_matrix_cc; // interactions cell / cell
+        FullMatrix<double> ip_matrix_cn; // interactions cell / neighbor
+        FullMatrix<double> ip_matrix_nc; // interactions neighbor / cell
+        FullMatrix<double> ip_matrix_nn; // interactions neighbor / neighbor
+
+        // The discrete Hessians of the shape functions of the cell, and of
+        // those of every neighbor (in the order of the neighbors), restricted
+        // to the cell. The latter grow with the numbers of neighbors and of
+        // their shape functions, see compute_discrete_hessians().
+        std::vector<std::vector<Tensor<2, dim>>> discrete_hessians;
+        std::vector<std::vector<std::vector<Tensor<2, dim>>>>
+          discrete_hessians_neigh;
+      };
+
+
+
+      template <int dim>
+      Matrix<dim>::Matrix(const hp::MappingCollection<dim> &mapping,
+                          const hp::FECollection<dim> &     fe,
+                          const hp::FECollection<dim> &     fe_lift,
+                          const hp::QCollection<dim> &      quad,
+                          const hp::QCollection<dim - 1> &  quad_face)
+        : fe_values(mapping, fe, quad, update_hessians | update_JxW_values)
+        , fe_face(mapping,
+                  fe,
+                  quad_face,
+                  update_values | update_gradients | update_normal_vectors)
+        , fe_face_neighbor(mapping,
+                           fe,
+                           quad_face,
+                           update_values | update_gradients |
+                             update_normal_vectors)
+        , fe_subface_neighbor(mapping,
+                              fe,
+                              quad_face,
+                              update_values | update_gradients |
+                                update_normal_vectors)
+        , lifting(mapping, fe, fe_lift, quad, quad_face)
+        , local_dof_indices(fe.max_dofs_per_cell())
+        , local_dof_indices_neighbor(fe.max_dofs_per_cell())
+        , local_dof_indices_neighbor_2(fe.max_dofs_per_cell())
+        , stiffness_matrix_cc(fe.max_dofs_per_cell(), fe.max_dofs_per_cell())
+        , stiffness_matrix_cn(fe.max_dofs_per_cell(), fe.max_dofs_per_cell())
+        , stiffness_matrix_nc(fe.max_dofs_per_cell(), fe.max_dofs_per_cell())
+        , stiffness_matrix_nn(fe.max_dofs_per_cell(), fe.max_dofs_per_cell())
+        , stiffness_matrix_n1n2(fe.max_dofs_per_cell(),
+                                fe.max_dofs_per_cell())
+        , stiffness_matrix_n2n1(fe.max_dofs_per_cell(),
+                                fe.max_dofs_per_cell())
+        , ip_matrix_cc(fe.max_dofs_per_cell(), fe.max_dofs_per_cell())
+        , ip_matrix_cn(fe.max_dofs_per_cell(), fe.max_dofs_per_cell())
+        , ip_matrix_nc(fe.max_dofs_per_cell(), fe.max_dofs_per_cell())
+        , ip_matrix_nn(fe.max_dofs_per_cell(), fe.max_dofs_per_cell())
+        , discrete_hessians(fe.max_dofs_per_cell(),
+                            std::vector<Tensor<2, dim>>(
+                              quad.max_n_quadrature_points()))
+      {}
+
+
+
+      template <int dim>
+      Matrix<dim>::Matrix(const Matrix<dim> &scratch_data)
+        : Matrix(scratch_data.fe_values.get_mapping_collection(),
+                 scratch_data.fe_values.get_fe_collection(),
+                 scratch_data.lifting.fe_values_lift.get_fe_collection(),
+                 scratch_data.fe_values.get_quadrature_collection(),
+                 scratch_data.fe_face.get_quadrature_collection())
+      {}
+
+
+
+      template <int dim>
+      struct RHS
+      {
+        RHS(const hp::MappingCollection<dim> &mapping,
+            const hp::FECollection<dim> &     fe,
+            const hp::QCollection<dim> &      quad);
 
-    FEFaceValues<dim> fe_face(
-      fe, quad_face, update_values | update_gradients | update_normal_vectors);
+        RHS(const RHS<dim> &scratch_data);
 
-    FEFaceValues<dim> fe_face_neighbor(
-      fe, quad_face, update_values | update_gradients | update_normal_vectors);
+        hp::FEValues<dim> fe_values;
 
-    const unsigned int n_dofs = fe_values.dofs_per_cell;
+        std::vector<double> rhs_values;
+      };
 
-    std::vector<types::global_dof_index> local_dof_indices(n_dofs);
-    std::vector<types::global_dof_index> local_dof_indices_neighbor(n_dofs);
-    std::vector<types::global_dof_index> local_dof_indices_neighbor_2(n_dofs);
-
-    FullMatrix<double> stiffness_matrix_cc(n_dofs,
-                                           n_dofs); // interactions cell / cell
-    FullMatrix<double> stiffness_matrix_cn(
-      n_dofs, n_dofs); // interactions cell / neighbor
-    FullMatrix<double> stiffness_matrix_nc(
-      n_dofs, n_dofs); // interactions neighbor / cell
-    FullMatrix<double> stiffness_matrix_nn(
-      n_dofs, n_dofs); // interactions neighbor / neighbor
-    FullMatrix<double> stiffness_matrix_n1n2(
-      n_dofs, n_dofs); // interactions neighbor1 / neighbor2
-    FullMatrix<double> stiffness_matrix_n2n1(
-      n_dofs, n_dofs); // interactions neighbor2 / neighbor1
-
-    FullMatrix<double> ip_matrix_cc(n_dofs, n_dofs); // interactions cell / cell
-    FullMatrix<double> ip_matrix_cn(n_dofs,
-                                    n_dofs); // interactions cell / neighbor
-    FullMatrix<double> ip_matrix_nc(n_dofs,
-                                    n_dofs); // interactions neighbor / cell
-    FullMatrix<double> ip_matrix_nn(n_dofs,
-                                    n_dofs); // interactions neighbor / neighbor
-
-    std::vector<std::vector<Tensor<2, dim>>> discrete_hessians(
-      n_dofs, std::vector<Tensor<2, dim>>(n_q_points));
-    std::vector<std::vector<std::vector<Tensor<2, dim>>>>
-      discrete_hessians_neigh(GeometryInfo<dim>::faces_per_cell,
-                              discrete_hessians);
 
-    for (const auto &cell : dof_handler.active_cell_iterators())
-      {
-        fe_values.reinit(cell);
-        cell->get_dof_indices(local_dof_indices);
 
-        compute_discrete_hessians(cell,
-                                  discrete_hessians,
-                                  discrete_hessians_neigh);
+      template <int dim>
+      RHS<dim>::RHS(const hp::MappingCollection<dim> &mapping,
+                    const hp::FECollection<dim> &     fe,
+                    const hp::QCollection<dim> &      quad)
+        : fe_values(mapping,
+                    fe,
+                    quad,
+                    update_values | update_quadrature_points |
+                      update_JxW_values)
+        , rhs_values(quad.max_n_quadrature_points())
+      {}
 
-        stiffness_matrix_cc = 0;
-        for (unsigned int q = 0; q < n_q_points; ++q)
-          {
-            const double dx = fe_values.JxW(q);
 
-            for (unsigned int i = 0; i < n_dofs; ++i)
-              for (unsigned int j = 0; j < n_dofs; ++j)
-                {
-                  const Tensor<2, dim> &H_i = discrete_hessians[i][q];
-                  const Tensor<2, dim> &H_j = discrete_hessians[j][q];
 
-                  stiffness_matrix_cc(i, j) += scalar_product(H_j, H_i) * dx;
-                }
-          }
+      template <int dim>
+      RHS<dim>::RHS(const RHS<dim> &scratch_data)
+        : RHS(scratch_data.fe_values.get_mapping_collection(),
+              scratch_data.fe_values.get_fe_collection(),
+              scratch_data.fe_values.get_quadrature_collection())
+      {}
 
-        for (unsigned int i = 0; i < n_dofs; ++i)
-          for (unsigned int j = 0; j < n_dofs; ++j)
-            {
-              matrix(local_dof_indices[i], local_dof_indices[j]) +=
-                stiffness_matrix_cc(i, j);
-            }
 
-        for (unsigned int face_no = 0; face_no < cell->n_faces(); ++face_no)
-          {
-            const typename DoFHandler<dim>::face_iterator face =
-              cell->face(face_no);
 
-            const bool at_boundary = face->at_boundary();
-            if (!at_boundary)
-              {
-                const typename DoFHandler<dim>::active_cell_iterator
-                  neighbor_cell = cell->neighbor(face_no);
-                neighbor_cell->get_dof_indices(local_dof_indices_neighbor);
+      // The vectors of values at the quadrature points are resized to the
+      // quadrature rule of every cell and face.
+      template <int dim>
+      struct Errors
+      {
+        Errors(const hp::MappingCollection<dim> &mapping,
+               const hp::FECollection<dim> &     fe,
+               const hp::QCollection<dim> &      quad,
+               const hp::QCollection<dim - 1> &  quad_face);
+
+        Errors(const Errors<dim> &scratch_data);
+
+        hp::FEValues<dim>        fe_values;
+        hp::FEFaceValues<dim>    fe_face;
+        hp::FEFaceValues<dim>    fe_face_neighbor;
+        hp::FESubfaceValues<dim> fe_subface_neighbor;
+
+        std::vector<double>         solution_values_cell;
+        std::vector<Tensor<1, dim>> solution_gradients_cell;
+        std::vector<Tensor<2, dim>> solution_hessians_cell;
+
+        std::vector<double>         solution_values;
+        std::vector<double>         solution_values_neigh;
+        std::vector<Tensor<1, dim>> solution_gradients;
+        std::vector<Tensor<1, dim>> solution_gradients_neigh;
+
+        std::vector<double>                  exact_values;
+        std::vector<Tensor<1, dim>>          exact_gradients;
+        std::vector<SymmetricTensor<2, dim>> exact_hessians;
+      };
+
+
+
+      template <int dim>
+      Errors<dim>::Errors(const hp::MappingCollection<dim> &mapping,
+                          const hp::FECollection<dim> &     fe,
+                          const hp::QCollection<dim> &      quad,
+                          const hp::QCollection<dim - 1> &  quad_face)
+        : fe_values(mapping,
+                    fe,
+                    quad,
+                    update_values | update_gradients | update_hessians |
+                      update_quadrature_points | update_JxW_values)
+        , fe_face(mapping,
+                  fe,
+                  quad_face,
+                  update_values | update_gradients | update_quadrature_points |
+                    update_JxW_values)
+        , fe_face_neighbor(mapping,
+                           fe,
+                           quad_face,
+                           update_values | update_gradients)
+        , fe_subface_neighbor(mapping,
+                              fe,
+                              quad_face,
+                              update_values | update_gradients)
+        , solution_values_cell(quad.max_n_quadrature_points())
+        , solution_gradients_cell(quad.max_n_quadrature_points())
+        , solution_hessians_cell(quad.max_n_quadrature_points())
+        , solution_values(quad_face.max_n_quadrature_points())
+        , solution_values_neigh(quad_face.max_n_quadrature_points())
+        , solution_gradients(quad_face.max_n_quadrature_points())
+        , solution_gradients_neigh(quad_face.max_n_quadrature_points())
+        , exact_values(quad.max_n_quadrature_points())
+        , exact_gradients(quad.max_n_quadrature_points())
+        , exact_hessians(quad.max_n_quadrature_points())
+      {}
+
+
+
+      template <int dim>
+      Errors<dim>::Errors(const Errors<dim> &scratch_data)
+        : Errors(scratch_data.fe_values.get_mapping_collection(),
+                 scratch_data.fe_values.get_fe_collection(),
+                 scratch_data.fe_values.get_quadrature_collection(),
+                 scratch_data.fe_face.get_quadrature_collection())
+      {}
+
+
+
+      // The objects needed to compute the error indicator of one cell. The
+      // values "here" are those of the cell on (a part of) one of its faces,
+      // and the values "there" those of the neighbor on the same part.
+      template <int dim>
+      struct Estimator
+      {
+        Estimator(const hp::MappingCollection<dim> &mapping,
+                  const hp::FECollection<dim> &     fe,
+                  const hp::QCollection<dim> &      quad,
+                  const hp::QCollection<dim - 1> &  quad_face);
+
+        Estimator(const Estimator<dim> &scratch_data);
+
+        hp::FEValues<dim>        fe_values;
+        hp::FEFaceValues<dim>    fe_face;
+        hp::FESubfaceValues<dim> fe_subface;
+        hp::FEFaceValues<dim>    fe_face_neighbor;
+        hp::FESubfaceValues<dim> fe_subface_neighbor;
+
+        std::vector<FaceNeighbor<dim>> neighbors;
+
+        Vector<double> local_dof_values;
+
+        std::vector<double> rhs_values;
+
+        std::vector<double>         values_here, values_there;
+        std::vector<Tensor<1, dim>> gradients_here, gradients_there;
+        std::vector<Tensor<2, dim>> hessians_here, hessians_there;
+        std::vector<Tensor<3, dim>> third_derivatives_here,
+          third_derivatives_there;
+      };
+
+
+
+      template <int dim>
+      Estimator<dim>::Estimator(const hp::MappingCollection<dim> &mapping,
+                                const hp::FECollection<dim> &     fe,
+                                const hp::QCollection<dim> &      quad,
+                                const hp::QCollection<dim - 1> &  quad_face)
+        : fe_values(mapping,
+                    fe,
+                    quad,
+                    update_inverse_jacobians | update_quadrature_points |
+                      update_JxW_values)
+        , fe_face(mapping,
+                  fe,
+                  quad_face,
+                  update_values | update_gradients | update_hessians |
+                    update_3rd_derivatives | update_normal_vectors |
+                    update_JxW_values)
+        , fe_subface(mapping,
+                     fe,
+                     quad_face,
+                     update_values | update_gradients | update_hessians |
+                       update_3rd_derivatives | update_normal_vectors |
+                       update_JxW_values)
+        , fe_face_neighbor(mapping,
+                           fe,
+                           quad_face,
+                           update_values | update_gradients |
+                             update_hessians | update_3rd_derivatives)
+        , fe_subface_neighbor(mapping,
+                              fe,
+                              quad_face,
+                              update_values | update_gradients |
+                                update_hessians | update_3rd_derivatives)
+        , local_dof_values(fe.max_dofs_per_cell())
+        , rhs_values(quad.max_n_quadrature_points())
+        , values_here(quad_face.max_n_quadrature_points())
+        , values_there(quad_face.max_n_quadrature_points())
+        , gradients_here(quad_face.max_n_quadrature_points())
+        , gradients_there(quad_face.max_n_quadrature_points())
+        , hessians_here(quad_face.max_n_quadrature_points())
+        , hessians_there(quad_face.max_n_quadrature_points())
+        , third_derivatives_here(quad_face.max_n_quadrature_points())
+        , third_derivatives_there(quad_face.max_n_quadrature_points())
+      {}
 
-                stiffness_matrix_cn = 0;
-                stiffness_matrix_nc = 0;
-                stiffness_matrix_nn = 0;
-                for (unsigned int q = 0; q < n_q_points; ++q)
-                  {
-                    const double dx = fe_values.JxW(q);
 
-                    for (unsigned int i = 0; i < n_dofs; ++i)
-                      {
-                        for (unsigned int j = 0; j < n_dofs; ++j)
-                          {
-                            const Tensor<2, dim> &H_i = discrete_hessians[i][q];
-                            const Tensor<2, dim> &H_j = discrete_hessians[j][q];
-
-                            const Tensor<2, dim> &H_i_neigh =
-                              discrete_hessians_neigh[face_no][i][q];
-                            const Tensor<2, dim> &H_j_neigh =
-                              discrete_hessians_neigh[face_no][j][q];
-
-                            stiffness_matrix_cn(i, j) +=
-                              scalar_product(H_j_neigh, H_i) * dx;
-                            stiffness_matrix_nc(i, j) +=
-                              scalar_product(H_j, H_i_neigh) * dx;
-                            stiffness_matrix_nn(i, j) +=
-                              scalar_product(H_j_neigh, H_i_neigh) * dx;
-                          }
-                      }
-                  }
 
-                for (unsigned int i = 0; i < n_dofs; ++i)
-                  {
-                    for (unsigned int j = 0; j < n_dofs; ++j)
-                      {
-                        matrix(local_dof_indices[i],
-                               local_dof_indices_neighbor[j]) +=
-                          stiffness_matrix_cn(i, j);
-                        matrix(local_dof_indices_neighbor[i],
-                               local_dof_indices[j]) +=
-                          stiffness_matrix_nc(i, j);
-                        matrix(local_dof_indices_neighbor[i],
-                               local_dof_indices_neighbor[j]) +=
-                          stiffness_matrix_nn(i, j);
-                      }
-                  }
+      template <int dim>
+      Estimator<dim>::Estimator(const Estimator<dim> &scratch_data)
+        : Estimator(scratch_data.fe_values.get_mapping_collection(),
+                    scratch_data.fe_values.get_fe_collection(),
+                    scratch_data.fe_values.get_quadrature_collection(),
+                    scratch_data.fe_face.get_quadrature_collection())
+      {}
+    } // namespace Scratch
 
-              } // boundary check
-          }     // for face
 
-        for (unsigned int face_no = 0; face_no < cell->n_faces() - 1; ++face_no)
-          {
-            const typename DoFHandler<dim>::face_iterator face =
-              cell->face(face_no);
 
-            const bool at_boundary = face->at_boundary();
-            if (!at_boundary)
-              {
+    namespace CopyData
+    {
+      // The contributions of one cell to the matrix. Besides the cell / cell
+      // block, a cell contributes to the rows and columns of its neighbors
+      // and of pairs of its neighbors, so the number of blocks varies from
+      // cell to cell. The blocks of previous cells are kept to reuse their
+      // memory, and only the first n_blocks entries are valid.
+      struct Matrix
+      {
+        struct Block
+        {
+          std::vector<types::global_dof_index> row_dof_indices;
+          std::vector<types::global_dof_index> column_dof_indices;
+          FullMatrix<double>                   matrix;
+        };
 
-                for (unsigned int face_no_2 = face_no + 1;
-                     face_no_2 < cell->n_faces();
-                     ++face_no_2)
-                  {
-                    const typename DoFHandler<dim>::face_iterator face_2 =
-                      cell->face(face_no_2);
-
-                    const bool at_boundary_2 = face_2->at_boundary();
-                    if (!at_boundary_2)
-                      {
-                        const typename DoFHandler<dim>::active_cell_iterator
-                          neighbor_cell = cell->neighbor(face_no);
-                        neighbor_cell->get_dof_indices(
-                          local_dof_indices_neighbor);
-                        const typename DoFHandler<dim>::active_cell_iterator
-                          neighbor_cell_2 = cell->neighbor(face_no_2);
-                        neighbor_cell_2->get_dof_indices(
-                          local_dof_indices_neighbor_2);
-
-                        stiffness_matrix_n1n2 = 0;
-                        stiffness_matrix_n2n1 = 0;
-
-                        for (unsigned int q = 0; q < n_q_points; ++q)
-                          {
-                            const double dx = fe_values.JxW(q);
-
-                            for (unsigned int i = 0; i < n_dofs; ++i)
-                              for (unsigned int j = 0; j < n_dofs; ++j)
-                                {
-                                  const Tensor<2, dim> &H_i_neigh =
-                                    discrete_hessians_neigh[face_no][i][q];
-                                  const Tensor<2, dim> &H_j_neigh =
-                                    discrete_hessians_neigh[face_no][j][q];
-
-                                  const Tensor<2, dim> &H_i_neigh2 =
-                                    discrete_hessians_neigh[face_no_2][i][q];
-                                  const Tensor<2, dim> &H_j_neigh2 =
-                                    discrete_hessians_neigh[face_no_2][j][q];
-
-                                  stiffness_matrix_n1n2(i, j) +=
-                                    scalar_product(H_j_neigh2, H_i_neigh) * dx;
-                                  stiffness_matrix_n2n1(i, j) +=
-                                    scalar_product(H_j_neigh, H_i_neigh2) * dx;
-                                }
-                          }
-
-                        for (unsigned int i = 0; i < n_dofs; ++i)
-                          for (unsigned int j = 0; j < n_dofs; ++j)
-                            {
-                              matrix(local_dof_indices_neighbor[i],
-                                     local_dof_indices_neighbor_2[j]) +=
-                                stiffness_matrix_n1n2(i, j);
-                              matrix(local_dof_indices_neighbor_2[i],
-                                     local_dof_indices_neighbor[j]) +=
-                                stiffness_matrix_n2n1(i, j);
-                            }
-                      } // boundary check face_2
-                  }     // for face_2
-              }         // boundary check face_1
-          }             // for face_1
+        void reset();
 
+        void add(const std::vector<types::global_dof_index> &row_dof_indices,
+                 const std::vector<types::global_dof_index> &column_dof_indices,
+                 const FullMatrix<double> &                  matrix);
 
-        for (unsigned int face_no = 0; face_no < cell->n_faces(); ++face_no)
-          {
-            const typename DoFHandler<dim>::face_iterator face =
-              cell->face(face_no);
+        std::vector<Block> blocks;
+        unsigned int       n_blocks = 0;
+      };
 
-            const double mesh_inv = 1.0 / face->diameter(); // h_e^{-1}
-            const double mesh3_inv =
-              1.0 / std::pow(face->diameter(), 3); // ĥ_e^{-3}
 
-            fe_face.reinit(cell, face_no);
 
-            ip_matrix_cc = 0; // filled in any case (boundary or interior face)
+      void Matrix::reset()
+      {
+        n_blocks = 0;
+      }
 
-            const bool at_boundary = face->at_boundary();
-            if (at_boundary)
-              {
-                for (unsigned int q = 0; q < n_q_points_face; ++q)
-                  {
-                    const double dx = fe_face.JxW(q);
 
-                    for (unsigned int i = 0; i < n_dofs; ++i)
-                      for (unsigned int j = 0; j < n_dofs; ++j)
-                        {
-                          ip_matrix_cc(i, j) += penalty_jump_grad * mesh_inv *
-                                                fe_face.shape_grad(j, q) *
-                                                fe_face.shape_grad(i, q) * dx;
-                          ip_matrix_cc(i, j) += penalty_jump_val * mesh3_inv *
-                                                fe_face.shape_value(j, q) *
-                                                fe_face.shape_value(i, q) * dx;
-                        }
-                  }
-              }
-            else
-              { // interior face
 
-                const typename DoFHandler<dim>::active_cell_iterator
-                                   neighbor_cell = cell->neighbor(face_no);
-                const unsigned int face_no_neighbor =
-                  cell->neighbor_of_neighbor(face_no);
+      void Matrix::add(
+        const std::vector<types::global_dof_index> &row_dof_indices,
+        const std::vector<types::global_dof_index> &column_dof_indices,
+        const FullMatrix<double> &                  matrix)
+      {
+        if (n_blocks == blocks.size())
+          blocks.emplace_back();
 
-                if (neighbor_cell->id() < cell->id())
-                  continue; // skip this face (already considered)
-                else
+        Block &block             = blocks[n_blocks];
+        block.row_dof_indices    = row_dof_indices;
+        block.column_dof_indices = column_dof_indices;
+        block.matrix             = matrix;
+
+        ++n_blocks;
+      }
+
+
+
+      struct RHS
+      {
+        Vector<double>                       local_rhs;
+        std::vector<types::global_dof_index> local_dof_indices;
+      };
+
+
+
+      struct Errors
+      {
+        CellId cell_id;
+        double error_H2;
+        double error_H1;
+        double error_L2;
+      };
+
+
+
+      struct Estimator
+      {
+        unsigned int active_cell_index;
+        double       indicator;
+      };
+    } // namespace CopyData
+  }   // namespace Assembly
+
+
+
+  // Sum of the given values, added in a fixed binary tree: first neighboring
+  // values, then neighboring partial sums, and so on. The result only
+  // depends on the values and their order, and the rounding errors grow
+  // like log(n) instead of n.
+  double pairwise_sum(std::vector<double> values)
+  {
+    if (values.empty())
+      return 0.;
+
+    while (values.size() > 1)
+      {
+        std::vector<double> sums((values.size() + 1) / 2);
+        for (unsigned int i = 0; i < sums.size(); ++i)
+          sums[i] = (2 * i + 1 < values.size() ?
+                       values[2 * i] + values[2 * i + 1] :
+                       values[2 * i]);
+        values.swap(sums);
+      }
+
+    return values[0];
+  }
+
+
+
+  // A map to which several threads may add entries while others read it.
+  // Every entry is added once, by the first thread that computed it, and
+  // never changed afterwards, so that find() can return a pointer to it
+  // that stays valid while further entries are added. Readers share the
+  // lock, which is only held exclusively while an entry is inserted.
+  template <typename Key, typename Value>
+  class ConcurrentCache
+  {
+  public:
+    const Value *find(const Key &key) const
+    {
+      std::shared_lock<std::shared_timed_mutex> lock(mutex);
+      const auto entry = entries.find(key);
+      return (entry != entries.end() ? &entry->second : nullptr);
+    }
+
+    void insert(const Key &key, Value &&value)
+    {
+      std::unique_lock<std::shared_timed_mutex> lock(mutex);
+      entries.emplace(key, std::move(value));
+    }
+
+  private:
+    mutable std::shared_timed_mutex mutex;
+    std::map<Key, Value>            entries;
+  };
+
+
+
+  // The data that only depends on the polynomial space and degrees: the
+  // finite element spaces, the quadrature rules and the fourth derivatives
+  // of the shape functions on the reference cell at the quadrature points,
+  // which FEValues does not provide. The collections hold one entry per
+  // degree from min_degree to max_degree, in this order, so that the active
+  // element of a cell is its degree minus min_degree; without p-refinement,
+  // they only hold one entry. The space of the liftings is the same as that
+  // of the solution in every component. The quadrature rules are those of
+  // the tensor-product space also for the space P, whose products of shape
+  // functions have the same degree in every variable. Apart from the
+  // cached liftings, the data is only read during a run, so one object can
+  // be shared by all problems of the same degrees, see run_batch().
+  template <int dim>
+  struct ReferenceData
+  {
+    ReferenceData(const std::string &polynomial_space,
+                  const unsigned int min_degree,
+                  const unsigned int max_degree)
+    {
+      const auto add_element = [this](const FiniteElement<dim> &element) {
+        fe.push_back(element);
+        fe_lift.push_back(FESystem<dim>(element, dim * dim));
+      };
+
+      for (unsigned int degree = min_degree; degree <= max_degree; ++degree)
+        {
+          if (polynomial_space == "P")
+            add_element(FE_DGP<dim>(degree));
+          else
+            add_element(FE_DGQ<dim>(degree));
+          quad.push_back(QGauss<dim>(degree + 1));
+          quad_face.push_back(QGauss<dim - 1>(degree + 1));
+        }
+
+      shape_4th_derivatives.resize(fe.size());
+      for (unsigned int k = 0; k < fe.size(); ++k)
+        {
+          shape_4th_derivatives[k].resize(
+            fe[k].n_dofs_per_cell(),
+            std::vector<Tensor<4, dim>>(quad[k].size()));
+          for (unsigned int i = 0; i < fe[k].n_dofs_per_cell(); ++i)
+            for (unsigned int q = 0; q < quad[k].size(); ++q)
+              shape_4th_derivatives[k][i][q] =
+                fe[k].shape_4th_derivative(i, quad[k].point(q));
+        }
+    }
+
+    hp::FECollection<dim>    fe;
+    hp::FECollection<dim>    fe_lift;
+    hp::QCollection<dim>     quad;
+    hp::QCollection<dim - 1> quad_face;
+
+    std::vector<std::vector<std::vector<Tensor<4, dim>>>>
+      shape_4th_derivatives;
+
+    // The discrete Hessians on a cell of size 1 for the configurations of
+    // faces met so far: of the shape functions of the cell, by its element
+    // and faces at the boundary, and of the shape functions of a neighbor,
+    // by the elements of both, the quadrature rule and the faces and
+    // subfaces they share. The liftings only depend on the elements and the
+    // quadrature rules, so they are filled by the threads of every problem
+    // sharing this object and reused by all of them, on all meshes. See
+    // compute_discrete_hessians().
+    mutable ConcurrentCache<std::pair<unsigned int, unsigned int>,
+                            std::vector<std::vector<Tensor<2, dim>>>>
+      cell_liftings;
+    mutable ConcurrentCache<std::array<unsigned int, 7>,
+                            std::vector<std::vector<Tensor<2, dim>>>>
+      neighbor_liftings;
+  };
+
+
+
+  struct ErrorNorms
+  {
+    double H2 = 0;
+    double H1 = 0;
+    double L2 = 0;
+  };
+
+
+
+  // The phases of a run timed by BiLaplacianLDGLift: first the main phases,
+  // which add up to the total time, then the time spent communicating in
+  // two of them.
+  const std::vector<std::string> timed_phases = {
+    "Make grid",
+    "Refine grid",
+    "Setup system",
+    "Assemble matrix",
+    "Assemble rhs",
+    "Solve",
+    "Compute errors",
+    "Estimate error",
+    "Output results",
+    "Assemble matrix: communication",
+    "Compute errors: communication"};
+  const unsigned int n_main_timed_phases = 9;
+
+  // The name of the column of a phase in the CSV files: the name of the
+  // phase in lower case, with underscores instead of spaces and without
+  // colons.
+  std::string phase_column_name(std::string phase)
+  {
+    phase.erase(std::remove(phase.begin(), phase.end(), ':'), phase.end());
+    std::replace(phase.begin(), phase.end(), ' ', '_');
+    std::transform(phase.begin(),
+                   phase.end(),
+                   phase.begin(),
+                   [](const char c) { return std::tolower(c); });
+    return phase;
+  }
+
+
+
+  // The size of the mesh, the errors and the wall time of every phase (the
+  // largest over all processes, in the order of timed_phases) of one cycle
+  // of a run.
+  struct CycleResults
+  {
+    types::global_cell_index n_cells;
+    types::global_dof_index  n_dofs;
+    ErrorNorms               errors;
+    std::vector<double>      wall_times;
+  };
+
+
+
+  // A copy of the patches built by DataOut, together with the names and
+  // the interpretation of the data sets, from which the output files are
+  // written. Unlike DataOut, it refers neither to the mesh nor to the
+  // vectors of the problem, so that the files can be written by another
+  // thread while the problem changes them. The snapshot is taken by a
+  // DataOutSnapshot::Source, which is used like DataOut.
+  template <int dim>
+  class DataOutSnapshot : public DataOutInterface<dim>
+  {
+  public:
+    using NonscalarDataRanges = std::vector<
+      std::tuple<unsigned int,
+                 unsigned int,
+                 std::string,
+                 DataComponentInterpretation::DataComponentInterpretation>>;
+
+    class Source : public DataOut<dim>
+    {
+    public:
+      std::shared_ptr<DataOutSnapshot<dim>> snapshot() const
+      {
+        return std::make_shared<DataOutSnapshot<dim>>(
+          this->get_patches(),
+          this->get_dataset_names(),
+          this->get_nonscalar_data_ranges());
+      }
+    };
+
+    DataOutSnapshot(const std::vector<DataOutBase::Patch<dim>> &patches,
+                    const std::vector<std::string> &            dataset_names,
+                    const NonscalarDataRanges &nonscalar_data_ranges)
+      : patches(patches)
+      , dataset_names(dataset_names)
+      , nonscalar_data_ranges(nonscalar_data_ranges)
+    {}
+
+  private:
+    virtual const std::vector<DataOutBase::Patch<dim>> &
+    get_patches() const override
+    {
+      return patches;
+    }
+
+    virtual std::vector<std::string> get_dataset_names() const override
+    {
+      return dataset_names;
+    }
+
+    virtual NonscalarDataRanges get_nonscalar_data_ranges() const override
+    {
+      return nonscalar_data_ranges;
+    }
+
+    const std::vector<DataOutBase::Patch<dim>> patches;
+    const std::vector<std::string>             dataset_names;
+    const NonscalarDataRanges                  nonscalar_data_ranges;
+  };
+
+
+
+  // A thread that writes files in the background, so that the program goes
+  // on with the next cycle while the output of the previous one is written.
+  // Every task writes some files and returns the number of bytes written.
+  // The tasks are done in the order in which they are submitted; if the
+  // given number of tasks is already waiting, submit() waits until the
+  // oldest one is done, which bounds the memory held by pending output.
+  // The destructor finishes all pending tasks, so that no output is lost
+  // when the problem ends, also through an exception. The tasks must not
+  // call MPI, since MPI is only initialized for calls from one thread at a
+  // time. The name, time and size of every finished task are recorded, as
+  // well as the time submit() and flush() waited for the tasks; the
+  // difference is the time spent writing that was hidden behind the
+  // computation. The records may only be read after flush().
+  class BackgroundWriter
+  {
+  public:
+    struct FinishedTask
+    {
+      std::string name;
+      double      time;
+      double      bytes;
+    };
+
+    BackgroundWriter(const unsigned int max_queue_length);
+    ~BackgroundWriter();
+
+    void submit(const std::string &name, std::function<double()> task);
+    void flush();
+
+    std::vector<FinishedTask> finished_tasks;
+    double                    wait_time = 0;
+
+  private:
+    using Task = std::pair<std::string, std::function<double()>>;
+
+    void work();
+
+    const unsigned int      max_queue_length;
+    std::deque<Task>        queue;
+    bool                    busy     = false;
+    bool                    stopping = false;
+    std::exception_ptr      exception;
+    std::mutex              mutex;
+    std::condition_variable task_queued;
+    std::condition_variable task_done;
+    std::thread             thread;
+  };
+
+
+
+  BackgroundWriter::BackgroundWriter(const unsigned int max_queue_length)
+    : max_queue_length(max_queue_length)
+    , thread([this]() { work(); })
+  {}
+
+
+
+  BackgroundWriter::~BackgroundWriter()
+  {
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      task_done.wait(lock, [this]() { return queue.empty() && !busy; });
+      stopping = true;
+    }
+    task_queued.notify_one();
+    thread.join();
+  }
+
+
+
+  void BackgroundWriter::submit(const std::string &     name,
+                                std::function<double()> task)
+  {
+    const auto start = std::chrono::steady_clock::now();
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      task_done.wait(lock,
+                     [this]() { return queue.size() < max_queue_length; });
+      if (exception)
+        std::rethrow_exception(std::exchange(exception, nullptr));
+      queue.emplace_back(name, std::move(task));
+    }
+    task_queued.notify_one();
+    wait_time += std::chrono::duration<double>(
+                   std::chrono::steady_clock::now() - start)
+                   .count();
+  }
+
+
+
+  // Wait until all tasks submitted so far are done, and pass on the first
+  // exception thrown by one of them. An exception is only passed on once,
+  // by submit() or flush(), so that the writer can be used again after it
+  // has been handled.
+  void BackgroundWriter::flush()
+  {
+    const auto start = std::chrono::steady_clock::now();
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      task_done.wait(lock, [this]() { return queue.empty() && !busy; });
+      if (exception)
+        std::rethrow_exception(std::exchange(exception, nullptr));
+    }
+    wait_time += std::chrono::duration<double>(
+                   std::chrono::steady_clock::now() - start)
+                   .count();
+  }
+
+
+
+  void BackgroundWriter::work()
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true)
+      {
+        task_queued.wait(lock, [this]() { return stopping || !queue.empty(); });
+        if (queue.empty())
+          return;
+
+        Task task = std::move(queue.front());
+        queue.pop_front();
+        busy = true;
+        lock.unlock();
+
+        const auto start = std::chrono::steady_clock::now();
+        double     bytes = 0;
+        try
+          {
+            bytes = task.second();
+          }
+        catch (...)
+          {
+            lock.lock();
+            if (!exception)
+              exception = std::current_exception();
+            lock.unlock();
+          }
+        const double time = std::chrono::duration<double>(
+                              std::chrono::steady_clock::now() - start)
+                              .count();
+
+        lock.lock();
+        finished_tasks.push_back({std::move(task.first), time, bytes});
+        busy = false;
+        task_done.notify_all();
+      }
+  }
+
+
+
+  // A smooth deformation of the unit square or cube onto itself, which
+  // moves every point x by
+  //   a sin(2 pi x_d) prod_{e != d} sin(pi x_e)
+  // in every direction d. The boundary stays in place, so the exact solution
+  // and the boundary conditions are those of the undeformed domain, but the
+  // cells of the mesh are curved. The inverse, which the manifold needs to
+  // place the new vertices of refined cells, is computed by Newton's method;
+  // it exists for amplitudes well below 1/(2 pi).
+  template <int dim>
+  class DeformedCubeManifold : public ChartManifold<dim>
+  {
+  public:
+    DeformedCubeManifold(const double amplitude)
+      : amplitude(amplitude)
+    {}
+
+    virtual std::unique_ptr<Manifold<dim>> clone() const override
+    {
+      return std::make_unique<DeformedCubeManifold<dim>>(amplitude);
+    }
+
+    virtual Point<dim>
+    push_forward(const Point<dim> &chart_point) const override;
+
+    virtual DerivativeForm<1, dim, dim>
+    push_forward_gradient(const Point<dim> &chart_point) const override;
+
+    virtual Point<dim> pull_back(const Point<dim> &space_point) const override;
+
+  private:
+    const double amplitude;
+  };
+
+
+
+  template <int dim>
+  Point<dim>
+  DeformedCubeManifold<dim>::push_forward(const Point<dim> &chart_point) const
+  {
+    Point<dim> space_point = chart_point;
+    for (unsigned int d = 0; d < dim; ++d)
+      {
+        double displacement =
+          amplitude * std::sin(2.0 * numbers::PI * chart_point[d]);
+        for (unsigned int e = 0; e < dim; ++e)
+          if (e != d)
+            displacement *= std::sin(numbers::PI * chart_point[e]);
+        space_point[d] += displacement;
+      }
+    return space_point;
+  }
+
+
+
+  template <int dim>
+  DerivativeForm<1, dim, dim> DeformedCubeManifold<dim>::push_forward_gradient(
+    const Point<dim> &chart_point) const
+  {
+    DerivativeForm<1, dim, dim> gradient;
+    for (unsigned int d = 0; d < dim; ++d)
+      {
+        gradient[d][d] = 1.0;
+        for (unsigned int f = 0; f < dim; ++f)
+          {
+            double derivative =
+              (f == d ?
+                 2.0 * numbers::PI *
+                   std::cos(2.0 * numbers::PI * chart_point[d]) :
+                 std::sin(2.0 * numbers::PI * chart_point[d]) * numbers::PI *
+                   std::cos(numbers::PI * chart_point[f]));
+            for (unsigned int e = 0; e < dim; ++e)
+              if (e != d && e != f)
+                derivative *= std::sin(numbers::PI * chart_point[e]);
+            gradient[d][f] += amplitude * derivative;
+          }
+      }
+    return gradient;
+  }
+
+
+
+  template <int dim>
+  Point<dim>
+  DeformedCubeManifold<dim>::pull_back(const Point<dim> &space_point) const
+  {
+    Point<dim> chart_point = space_point;
+    for (unsigned int iteration = 0; iteration < 50; ++iteration)
+      {
+        const Tensor<1, dim> residual =
+          push_forward(chart_point) - space_point;
+        if (residual.norm() < 1e-14)
+          break;
+
+        const Tensor<2, dim> jacobian = push_forward_gradient(chart_point);
+        chart_point -= invert(jacobian) * residual;
+      }
+    return chart_point;
+  }
+
+
+
+  template <int dim, typename LinearAlgebra>
+  class BiLaplacianLDGLift
+  {
+  public:
+    // A quiet problem neither prints anything nor writes any files; this is
+    // used for the problems of a batch.
+    BiLaplacianLDGLift(
+      const Parameters &                               parameters,
+      const std::shared_ptr<const ReferenceData<dim>> &reference_data,
+      const MPI_Comm &mpi_communicator = MPI_COMM_WORLD,
+      const bool      quiet            = false);
+
+    void run();
+
+    types::global_dof_index          n_dofs() const;
+    const ErrorNorms &               get_errors() const;
+    const std::vector<CycleResults> &get_cycle_results() const;
+
+  private:
+    void make_grid();
+    void read_mesh();
+    void refine_grid();
+    void setup_mapping();
+    void renumber_dofs();
+    void setup_system();
+    void assemble_system();
+    void assemble_matrix();
+    void assemble_rhs();
+
+    void solve();
+    void benchmark_matrix_vector_product();
+
+    ErrorNorms compute_errors();
+    void estimate_error();
+    void output_results(const unsigned int cycle) const;
+    void write_timings() const;
+
+    void local_assemble_matrix(
+      const typename DoFHandler<dim>::active_cell_iterator &cell,
+      Assembly::Scratch::Matrix<dim> &                      scratch_data,
+      Assembly::CopyData::Matrix &                          copy_data);
+    void
+    copy_local_to_global_matrix(const Assembly::CopyData::Matrix &copy_data);
+
+    void store_cell_matrix_rows();
+    void find_reused_matrix_rows();
+    bool reuse_cell_matrix(
+      const typename DoFHandler<dim>::active_cell_iterator &cell,
+      const std::vector<FaceNeighbor<dim>> &                neighbors,
+      Assembly::CopyData::Matrix &                          copy_data);
+    void discard_reused_rows(
+      const typename DoFHandler<dim>::active_cell_iterator &cell,
+      const std::vector<FaceNeighbor<dim>> &                neighbors,
+      Assembly::CopyData::Matrix &                          copy_data,
+      const unsigned int first_block) const;
+
+    void local_assemble_rhs(
+      const typename DoFHandler<dim>::active_cell_iterator &cell,
+      Assembly::Scratch::RHS<dim> &                         scratch_data,
+      Assembly::CopyData::RHS &                             copy_data);
+    void copy_local_to_global_rhs(const Assembly::CopyData::RHS &copy_data);
+
+    void local_compute_errors(
+      const typename DoFHandler<dim>::active_cell_iterator &cell,
+      Assembly::Scratch::Errors<dim> &                      scratch_data,
+      Assembly::CopyData::Errors &                          copy_data);
+
+    void local_estimate_error(
+      const typename DoFHandler<dim>::active_cell_iterator &cell,
+      Assembly::Scratch::Estimator<dim> &                   scratch_data,
+      Assembly::CopyData::Estimator &                       copy_data);
+
+    void assemble_mass_matrix_inverse(
+      const FEValues<dim> &fe_values,
+      FullMatrix<double> & mass_matrix_inverse) const;
+    void apply_mass_matrix_inverse(
+      const FiniteElement<dim> &fe_lift,
+      const FullMatrix<double> &mass_matrix_inverse,
+      const Vector<double> &    rhs_lift,
+      Vector<double> &          coeffs_lift) const;
+
+    void compute_discrete_hessians(
+      const typename DoFHandler<dim>::active_cell_iterator &cell,
+      const std::vector<FaceNeighbor<dim>> &                neighbors,
+      Assembly::Scratch::Lifting<dim> &                     scratch_data,
+      std::vector<std::vector<Tensor<2, dim>>> &            discrete_hessians,
+      std::vector<std::vector<std::vector<Tensor<2, dim>>>>
+        &discrete_hessians_neigh);
+
+    double cell_cost(const CellAccessor<dim> &cell,
+                     const unsigned int       n_dofs_per_cell) const;
+    void read_cell_costs();
+    void write_cell_costs() const;
+    void setup_cell_chunks();
+    bool colored_assembly() const;
+    void setup_cell_colors();
+    void assemble_matrix_colored();
+    void first_touch(typename LinearAlgebra::Vector &vector) const;
+    bool is_halo_cell(
+      const typename DoFHandler<dim>::active_cell_iterator &cell) const;
+    void start_off_process_exchange();
+    void progress_off_process_exchange();
+    void finish_off_process_exchange();
+
+    using CellFilter =
+      FilteredIterator<typename DoFHandler<dim>::active_cell_iterator>;
+
+    using CellChunk =
+      std::vector<typename DoFHandler<dim>::active_cell_iterator>;
+
+    MPI_Comm mpi_communicator;
+
+    // Each process only stores its locally owned cells and one layer of
+    // ghost cells around them. This is sufficient for the lifted operator:
+    // the contributions of a cell couple the cell itself, its face
+    // neighbors and pairs of its face neighbors, all of which are owned or
+    // ghost cells for the process owning the cell. Entries in rows owned by
+    // another process are sent to their owner when the matrix is
+    // compressed, which is the exchange that otherwise would require a
+    // second layer of ghost cells.
+    parallel::distributed::Triangulation<dim> triangulation;
+
+    const unsigned int n_refinements;
+
+    const std::shared_ptr<const ReferenceData<dim>> reference_data;
+
+    // The elements of all polynomial degrees a cell may have, see
+    // ReferenceData.
+    const hp::FECollection<dim> &fe;
+    DoFHandler<dim>              dof_handler;
+
+    const hp::FECollection<dim> &fe_lift;
+
+    // The mapping of all cells. Its support points are computed from the
+    // manifold once per mesh and cached, so that the geometry of a cell is
+    // not recomputed in every loop over the cells (assembly, errors,
+    // estimator, output), which only evaluate the Jacobians from these
+    // points. The collection holds this mapping for the hp objects.
+    MappingQCache<dim>         mapping;
+    hp::MappingCollection<dim> mapping_collection;
+
+    IndexSet              locally_owned_dofs;
+    IndexSet              locally_relevant_dofs;
+    std::vector<IndexSet> locally_owned_dofs_per_process;
+
+    // Only used by the deal.II backend, whose matrix does not store its own
+    // sparsity pattern.
+    SparsityPattern sparsity_pattern;
+
+    typename LinearAlgebra::SparseMatrix matrix;
+    typename LinearAlgebra::Vector       rhs;
+    typename LinearAlgebra::Vector       solution;
+
+    // The solution including the values on the ghost cells. This is a
+    // deal.II vector for all backends, since it allows to start the update
+    // of the ghost values and to finish it later, see compute_errors().
+    dealii::LinearAlgebra::distributed::Vector<double>
+      locally_relevant_solution;
+
+    const Parameters parameters;
+
+    const double penalty_jump_grad;
+    const double penalty_jump_val;
+
+    const bool                quiet;
+    ErrorNorms                errors;
+    std::vector<CycleResults> cycle_results;
+
+    // The thread that writes the output files, if they are written in the
+    // background.
+    std::unique_ptr<BackgroundWriter> background_writer;
+
+    // The error indicator of every active cell (zero on cells that are not
+    // locally owned), and the transfer of the solution to the refined mesh,
+    // which only exists between refine_grid() and setup_system().
+    Vector<float> estimated_error_per_cell;
+    std::unique_ptr<parallel::distributed::SolutionTransfer<
+      dim,
+      dealii::LinearAlgebra::distributed::Vector<double>>>
+      solution_transfer;
+
+    // The expansion of the solution into Legendre polynomials whose decay
+    // decides between h- and p-refinement, created on first use.
+    std::unique_ptr<FESeries::Legendre<dim>> legendre;
+
+    // The cost of a cell in the matrix assembly varies with the number of
+    // its interior faces: every interior face adds a lifting and three
+    // blocks, and every pair of interior faces two more blocks. The
+    // partitioning of the cells between the MPI processes and the chunks of
+    // cells handed to the threads are therefore weighted by the cost of the
+    // cells, either estimated by cell_cost() or measured in a previous run.
+    std::map<CellId, double> measured_cell_costs;
+    Vector<float>            cell_assembly_times;
+    std::vector<CellChunk>   cell_chunks;
+    unsigned int             n_halo_chunks;
+
+    // The locally owned cells in the order of their degrees of freedom, see
+    // renumber_dofs(). The chunks are consecutive ranges of these cells.
+    CellChunk owned_cells;
+
+    // The rows of the matrix of a cell on the previous mesh, kept for the
+    // incremental assembly by the id of the cell. The ids and the active FE
+    // indices of the cell and of its face neighbors tell whether the cell
+    // is unchanged. The rows are only kept if they may be copied, see
+    // store_cell_matrix_rows(), split into one block per cell up to two
+    // faces away in the order of get_two_ring(), so that they can be added
+    // again whatever the new numbering of the DoFs.
+    struct CellMatrixRows
+    {
+      std::vector<std::pair<CellId, unsigned int>> cells;
+      std::vector<FullMatrix<double>>              blocks;
+    };
+    std::map<CellId, CellMatrixRows> previous_cell_matrix_rows;
+
+    // The right hand side of a cell on the previous mesh, with its active
+    // FE index.
+    std::map<CellId, std::pair<unsigned int, Vector<double>>>
+      previous_cell_rhs;
+
+    // Whether the rows of a cell are copied in the current assembly, by
+    // active cell index.
+    std::vector<bool> reused_matrix_rows;
+
+    std::atomic<unsigned int> n_reused_cells;
+    std::atomic<unsigned int> n_recomputed_cells;
+    std::atomic<unsigned int> n_reused_rhs_cells;
+    double                    store_rows_time = 0;
+
+    // Provides the weights of the cells to p4est, knowing the polynomial
+    // degree every cell will have after the refinement.
+    std::unique_ptr<parallel::CellWeights<dim>> cell_weights;
+
+    // The cells grouped by colors for the colored assembly schedule.
+    std::vector<std::vector<CellFilter>> cell_colors;
+
+    // In the deterministic mode and when overlapping communication, the
+    // entries in rows owned by other processes are collected here during
+    // the assembly, for each of these processes as pairs of row and column
+    // indices and the values, and then sent by start_off_process_exchange().
+    std::map<unsigned int,
+             std::pair<std::vector<types::global_dof_index>,
+                       std::vector<double>>>
+      off_process_entries;
+
+    // The messages of this exchange with the processes that own ghost
+    // cells, which are the only ones entries are sent to or received from.
+    // Every process first sends the size of its message to each of them,
+    // and then the message itself.
+    struct OffProcessExchange
+    {
+      static constexpr int size_tag = 8201;
+      static constexpr int data_tag = 8202;
+
+      std::vector<unsigned int>       processes;
+      std::vector<unsigned long long> send_sizes;
+      std::vector<unsigned long long> receive_sizes;
+      std::vector<std::vector<char>>  send_buffers;
+      std::vector<std::vector<char>>  receive_buffers;
+      std::vector<MPI_Request>        send_requests;
+      std::vector<MPI_Request>        size_requests;
+      std::vector<MPI_Request>        receive_requests;
+      std::vector<bool>               receive_posted;
+      bool                            in_progress = false;
+    } off_process_exchange;
+
+    ConditionalOStream pcout;
+    TimerOutput        computing_timer;
+  };
+
+
+
+  // The exact solution is the product of the functions (x_d (1 - x_d))^2 of
+  // one coordinate each, and the right hand side is its bilaplacian. Every
+  // derivative of the solution is a product of these functions and of their
+  // first and second derivatives, which are computed once per coordinate
+  // and shared by all terms. The functions are written for a generic number
+  // type, so that they evaluate one point with double and several points at
+  // once, one per lane, with VectorizedArray<double>.
+  template <int dim, typename Number>
+  struct ProductFactors
+  {
+    ProductFactors(const Point<dim, Number> &p)
+    {
+      for (unsigned int d = 0; d < dim; ++d)
+        {
+          const Number x = p[d];
+          const Number g = x * (1.0 - x);
+          f[d]           = g * g;
+          df[d]          = 2.0 * g * (1.0 - 2.0 * x);
+          ddf[d]         = 2.0 - 12.0 * g;
+        }
+    }
+
+    // The product of f over all coordinates but d and e (or only d, if
+    // d == e, or none, if both are dim).
+    Number product_without(const unsigned int d, const unsigned int e) const
+    {
+      Number product;
+      product = 1.0;
+      for (unsigned int c = 0; c < dim; ++c)
+        if (c != d && c != e)
+          product *= f[c];
+      return product;
+    }
+
+    std::array<Number, dim> f, df, ddf;
+  };
+
+
+
+  template <int dim, typename Number>
+  Number right_hand_side_value(const Point<dim, Number> &p)
+  {
+    const ProductFactors<dim, Number> factors(p);
+
+    Number value;
+    value = 0.0;
+    for (unsigned int d = 0; d < dim; ++d)
+      {
+        value += 24.0 * factors.product_without(d, d);
+        for (unsigned int e = d + 1; e < dim; ++e)
+          value += 2.0 * factors.ddf[d] * factors.ddf[e] *
+                   factors.product_without(d, e);
+      }
+    return value;
+  }
+
+
+
+  template <int dim, typename Number>
+  void exact_solution_value_gradient_hessian(
+    const Point<dim, Number> &       p,
+    Number &                         value,
+    Tensor<1, dim, Number> &         gradient,
+    SymmetricTensor<2, dim, Number> &hessian)
+  {
+    const ProductFactors<dim, Number> factors(p);
+
+    value = factors.product_without(dim, dim);
+    for (unsigned int d = 0; d < dim; ++d)
+      {
+        gradient[d]   = factors.df[d] * factors.product_without(d, d);
+        hessian[d][d] = factors.ddf[d] * factors.product_without(d, d);
+        for (unsigned int e = d + 1; e < dim; ++e)
+          hessian[d][e] =
+            factors.df[d] * factors.df[e] * factors.product_without(d, e);
+      }
+  }
+
+
+
+  // Copy the points from the given one on into the lanes of a vectorized
+  // point and return the number of points copied. Lanes past the last point
+  // repeat it, so that they hold valid coordinates.
+  template <int dim>
+  unsigned int
+  vectorize_points(const std::vector<Point<dim>> &      points,
+                   const unsigned int                   first,
+                   Point<dim, VectorizedArray<double>> &vectorized_point)
+  {
+    const unsigned int n_lanes =
+      std::min<unsigned int>(VectorizedArray<double>::size(),
+                             points.size() - first);
+    for (unsigned int v = 0; v < VectorizedArray<double>::size(); ++v)
+      for (unsigned int d = 0; d < dim; ++d)
+        vectorized_point[d][v] = points[first + std::min(v, n_lanes - 1)][d];
+    return n_lanes;
+  }
+
+
+
+  // The functions are evaluated at all quadrature points of a cell or face
+  // at once through value_list() and value_gradient_hessian_list(), which
+  // work on as many points at a time as there are lanes in a
+  // VectorizedArray<double>.
+  template <int dim>
+  class RightHandSide : public Function<dim>
+  {
+  public:
+    RightHandSide()
+      : Function<dim>()
+    {}
+
+    virtual double value(const Point<dim> & p,
+                         const unsigned int component = 0) const override;
+
+    virtual void value_list(const std::vector<Point<dim>> &points,
+                            std::vector<double> &          values,
+                            const unsigned int component = 0) const override;
+  };
+
+
+
+  template <int dim>
+  double RightHandSide<dim>::value(const Point<dim> &p,
+                                   const unsigned int /*component*/) const
+  {
+    return right_hand_side_value(p);
+  }
+
+
+
+  template <int dim>
+  void RightHandSide<dim>::value_list(const std::vector<Point<dim>> &points,
+                                      std::vector<double> &          values,
+                                      const unsigned int /*component*/) const
+  {
+    AssertDimension(values.size(), points.size());
+
+    Point<dim, VectorizedArray<double>> p;
+    for (unsigned int q = 0; q < points.size();
+         q += VectorizedArray<double>::size())
+      {
+        const unsigned int            n_lanes = vectorize_points(points, q, p);
+        const VectorizedArray<double> value   = right_hand_side_value(p);
+        for (unsigned int v = 0; v < n_lanes; ++v)
+          values[q + v] = value[v];
+      }
+  }
+
+
+
+  template <int dim>
+  class ExactSolution : public Function<dim>
+  {
+  public:
+    ExactSolution()
+      : Function<dim>()
+    {}
+
+    virtual double value(const Point<dim> & p,
+                         const unsigned int component = 0) const override;
+
+    virtual Tensor<1, dim>
+    gradient(const Point<dim> & p,
+             const unsigned int component = 0) const override;
+
+    virtual SymmetricTensor<2, dim>
+    hessian(const Point<dim> & p,
+            const unsigned int component = 0) const override;
+
+    virtual void value_list(const std::vector<Point<dim>> &points,
+                            std::vector<double> &          values,
+                            const unsigned int component = 0) const override;
+
+    void value_gradient_hessian_list(
+      const std::vector<Point<dim>> &       points,
+      std::vector<double> &                 values,
+      std::vector<Tensor<1, dim>> &         gradients,
+      std::vector<SymmetricTensor<2, dim>> &hessians) const;
+  };
+
+
+
+  template <int dim>
+  double ExactSolution<dim>::value(const Point<dim> &p,
+                                   const unsigned int /*component*/) const
+  {
+    return ProductFactors<dim, double>(p).product_without(dim, dim);
+  }
+
+
+
+  template <int dim>
+  Tensor<1, dim>
+  ExactSolution<dim>::gradient(const Point<dim> &p,
+                               const unsigned int /*component*/) const
+  {
+    double                  value;
+    Tensor<1, dim>          gradient;
+    SymmetricTensor<2, dim> hessian;
+    exact_solution_value_gradient_hessian(p, value, gradient, hessian);
+    return gradient;
+  }
+
+
+
+  template <int dim>
+  SymmetricTensor<2, dim>
+  ExactSolution<dim>::hessian(const Point<dim> &p,
+                              const unsigned int /*component*/) const
+  {
+    double                  value;
+    Tensor<1, dim>          gradient;
+    SymmetricTensor<2, dim> hessian;
+    exact_solution_value_gradient_hessian(p, value, gradient, hessian);
+    return hessian;
+  }
+
+
+
+  template <int dim>
+  void ExactSolution<dim>::value_list(const std::vector<Point<dim>> &points,
+                                      std::vector<double> &          values,
+                                      const unsigned int /*component*/) const
+  {
+    AssertDimension(values.size(), points.size());
+
+    Point<dim, VectorizedArray<double>> p;
+    for (unsigned int q = 0; q < points.size();
+         q += VectorizedArray<double>::size())
+      {
+        const unsigned int n_lanes = vectorize_points(points, q, p);
+        const VectorizedArray<double> value =
+          ProductFactors<dim, VectorizedArray<double>>(p).product_without(dim,
+                                                                          dim);
+        for (unsigned int v = 0; v < n_lanes; ++v)
+          values[q + v] = value[v];
+      }
+  }
+
+
+
+  template <int dim>
+  void ExactSolution<dim>::value_gradient_hessian_list(
+    const std::vector<Point<dim>> &       points,
+    std::vector<double> &                 values,
+    std::vector<Tensor<1, dim>> &         gradients,
+    std::vector<SymmetricTensor<2, dim>> &hessians) const
+  {
+    AssertDimension(values.size(), points.size());
+    AssertDimension(gradients.size(), points.size());
+    AssertDimension(hessians.size(), points.size());
+
+    Point<dim, VectorizedArray<double>>              p;
+    VectorizedArray<double>                          value;
+    Tensor<1, dim, VectorizedArray<double>>          gradient;
+    SymmetricTensor<2, dim, VectorizedArray<double>> hessian;
+    for (unsigned int q = 0; q < points.size();
+         q += VectorizedArray<double>::size())
+      {
+        const unsigned int n_lanes = vectorize_points(points, q, p);
+        exact_solution_value_gradient_hessian(p, value, gradient, hessian);
+        for (unsigned int v = 0; v < n_lanes; ++v)
+          {
+            values[q + v] = value[v];
+            for (unsigned int d = 0; d < dim; ++d)
+              {
+                gradients[q + v][d] = gradient[d][v];
+                for (unsigned int e = d; e < dim; ++e)
+                  hessians[q + v][d][e] = hessian[d][e][v];
+              }
+          }
+      }
+  }
+
+
+
+  template <int dim, typename LinearAlgebra>
+  BiLaplacianLDGLift<dim, LinearAlgebra>::BiLaplacianLDGLift(
+    const Parameters &                               parameters,
+    const std::shared_ptr<const ReferenceData<dim>> &reference_data,
+    const MPI_Comm &                                 mpi_communicator,
+    const bool                                       quiet)
+    : mpi_communicator(mpi_communicator)
+    , triangulation(mpi_communicator)
+    , n_refinements(parameters.n_refinements)
+    , reference_data(reference_data)
+    , fe(reference_data->fe)
+    , dof_handler(triangulation)
+    , fe_lift(reference_data->fe_lift)
+    , mapping(parameters.mapping_degree)
+    , parameters(parameters)
+    , penalty_jump_grad(parameters.penalty_jump_grad)
+    , penalty_jump_val(parameters.penalty_jump_val)
+    , quiet(quiet)
+    , background_writer(!quiet && parameters.asynchronous_output ?
+                          std::make_unique<BackgroundWriter>(
+                            parameters.output_queue_length) :
+                          nullptr)
+    , pcout(std::cout,
+            !quiet &&
+              (Utilities::MPI::this_mpi_process(mpi_communicator) == 0))
+    , computing_timer(mpi_communicator,
+                      pcout,
+                      TimerOutput::summary,
+                      TimerOutput::wall_times)
+  {
+    if (parameters.assembly_schedule == "colored" && !colored_assembly())
+      pcout << "Warning: the colored assembly schedule needs the deal.II "
+            << "backend. The matrix is assembled in chunks instead."
+            << std::endl;
+  }
+
+
+
+  // Read the coarse mesh from the mesh file and create the triangulation
+  // from its cells in a new order. The cells of a file generated by a mesh
+  // generator come in an arbitrary order, while the cells of the refined
+  // mesh and their degrees of freedom are numbered in the order of the
+  // coarse cells they descend from. Neighboring cells far apart in this
+  // order make the matrix assembly, which accesses a cell together with its
+  // neighbors, and the matrix-vector products jump through memory. The
+  // cells are therefore renumbered by the Cuthill-McKee algorithm or
+  // hierarchically on the graph of cells sharing a face. The bandwidth of
+  // this graph and the mean distance between the indices of neighboring
+  // cells are printed for both orders. They are only a proxy for the
+  // locality of the memory accesses, not measured cache misses. The
+  // boundary and manifold ids the file gives to the faces on the boundary
+  // are kept.
+  template <int dim, typename LinearAlgebra>
+  void BiLaplacianLDGLift<dim, LinearAlgebra>::read_mesh()
+  {
+    Triangulation<dim> file_triangulation;
+    GridIn<dim>        grid_in;
+    grid_in.attach_triangulation(file_triangulation);
+    grid_in.read(parameters.mesh_file);
+
+    DynamicSparsityPattern cell_connectivity;
+    GridTools::get_face_connectivity_of_cells(file_triangulation,
+                                              cell_connectivity);
+
+    const unsigned int n_cells = file_triangulation.n_active_cells();
+
+    std::vector<types::global_dof_index> new_indices(n_cells);
+    if (parameters.cell_ordering == "cuthill_mckee")
+      SparsityTools::reorder_Cuthill_McKee(cell_connectivity, new_indices);
+    else if (parameters.cell_ordering == "hierarchical")
+      SparsityTools::reorder_hierarchical(cell_connectivity, new_indices);
+    else
+      std::iota(new_indices.begin(), new_indices.end(), 0);
+
+    const auto print_locality =
+      [&](const std::string &                         order,
+          const std::vector<types::global_dof_index> &indices) {
+        types::global_dof_index bandwidth      = 0;
+        double                  total_distance = 0;
+        unsigned int            n_neighbors    = 0;
+        for (unsigned int i = 0; i < n_cells; ++i)
+          for (auto entry = cell_connectivity.begin(i);
+               entry != cell_connectivity.end(i);
+               ++entry)
+            if (entry->column() != i)
+              {
+                const types::global_dof_index distance =
+                  std::max(indices[i], indices[entry->column()]) -
+                  std::min(indices[i], indices[entry->column()]);
+                bandwidth = std::max(bandwidth, distance);
+                total_distance += distance;
+                ++n_neighbors;
+              }
+
+        // A mesh of a single cell has no neighbors.
+        pcout << "   " << order
+              << " cell order (locality proxy): bandwidth " << bandwidth
+              << ", mean distance of neighbors "
+              << (n_neighbors > 0 ? total_distance / n_neighbors : 0.)
+              << std::endl;
+      };
+
+    std::vector<types::global_dof_index> file_indices(n_cells);
+    std::iota(file_indices.begin(), file_indices.end(), 0);
+
+    pcout << "Read " << n_cells << " cells from " << parameters.mesh_file
+          << std::endl;
+    print_locality("File", file_indices);
+    if (parameters.cell_ordering != "none")
+      print_locality("New", new_indices);
+
+    std::vector<CellData<dim>> cells(n_cells);
+    for (const auto &cell : file_triangulation.active_cell_iterators())
+      {
+        CellData<dim> &cell_data =
+          cells[new_indices[cell->active_cell_index()]];
+        for (const unsigned int v : cell->vertex_indices())
+          cell_data.vertices[v] = cell->vertex_index(v);
+        cell_data.material_id = cell->material_id();
+        cell_data.manifold_id = cell->manifold_id();
+      }
+
+    SubCellData subcell_data;
+    for (const auto &face : file_triangulation.active_face_iterators())
+      if (face->at_boundary() &&
+          (face->boundary_id() != 0 ||
+           face->manifold_id() != numbers::flat_manifold_id))
+        {
+          CellData<dim - 1> face_data;
+          for (const unsigned int v : face->vertex_indices())
+            face_data.vertices[v] = face->vertex_index(v);
+          face_data.boundary_id = face->boundary_id();
+          face_data.manifold_id = face->manifold_id();
+          add_boundary_face(subcell_data, face_data);
+        }
+
+    triangulation.create_triangulation(file_triangulation.get_vertices(),
+                                       cells,
+                                       subcell_data);
+  }
+
+
+
+  template <int dim, typename LinearAlgebra>
+  void BiLaplacianLDGLift<dim, LinearAlgebra>::make_grid()
+  {
+    pcout << "Building the mesh............." << std::endl;
+
+    if (parameters.cell_cost_model == "measured")
+      read_cell_costs();
+
+    // With a non-uniform cost model, p4est partitions the mesh such that
+    // every process gets the same total weight instead of the same number of
+    // cells. Note that p4est adds a fixed weight of 1000 to every cell.
+    if (parameters.cell_cost_model != "uniform")
+      cell_weights = std::make_unique<parallel::CellWeights<dim>>(
+        dof_handler,
+        [this](const typename DoFHandler<dim>::cell_iterator &cell,
+               const FiniteElement<dim> &future_fe) -> unsigned int {
+          return static_cast<unsigned int>(
+            1000. * cell_cost(*cell, future_fe.n_dofs_per_cell()));
+        });
+
+    // The memory of the mesh is measured as the growth of the peak memory
+    // of every process while the mesh is built, which includes the
+    // temporary data of p4est and of the refinement, and not only the
+    // final triangulation. It is zero if the peak stays below an earlier
+    // one of the process.
+    Utilities::System::MemoryStats memory_before;
+    Utilities::System::get_memory_stats(memory_before);
+
+    const auto start = std::chrono::steady_clock::now();
+
+    if (parameters.mesh_file.empty())
+      GridGenerator::hyper_cube(triangulation, 0.0, 1.0);
+    else
+      read_mesh();
+
+    // The vertices of the refined cells are placed on the deformed domain.
+    if (parameters.mesh_file.empty() && parameters.mesh_distortion > 0)
+      {
+        const DeformedCubeManifold<dim> manifold(parameters.mesh_distortion);
+        triangulation.set_all_manifold_ids(0);
+        triangulation.set_manifold(0, manifold);
+      }
+
+    // The elements are known to the DoFHandler before the mesh is refined,
+    // so that the weights of the cells are available when p4est partitions
+    // the refined mesh. All cells start with the lowest degree.
+    dof_handler.distribute_dofs(fe);
+
+    triangulation.refine_global(n_refinements);
+
+    const double build_time = Utilities::MPI::max(
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+        .count(),
+      mpi_communicator);
+    const double triangulation_memory = Utilities::MPI::max(
+      triangulation.memory_consumption() / 1048576., mpi_communicator);
+
+    Utilities::System::MemoryStats memory_after;
+    Utilities::System::get_memory_stats(memory_after);
+    const double peak_memory_growth = Utilities::MPI::max(
+      (static_cast<double>(memory_after.VmHWM) -
+       static_cast<double>(memory_before.VmHWM)) /
+        1024.,
+      mpi_communicator);
+
+    pcout << "Mesh built in " << build_time
+          << " s, memory of the triangulation: " << triangulation_memory
+          << " MB per process (max), growth of the peak memory while "
+          << "building it: " << peak_memory_growth << " MB per process (max)"
+          << std::endl;
+
+    pcout << "Number of active cells: "
+          << triangulation.n_global_active_cells() << std::endl;
+    pcout << "Number of MPI processes: "
+          << Utilities::MPI::n_mpi_processes(mpi_communicator) << std::endl;
+    pcout << "Number of threads per process: " << MultithreadInfo::n_threads()
+          << std::endl;
+  }
+
+
+
+  // Refine all cells, or the fraction of the cells with the largest error
+  // indicators, and prepare the transfer of the solution to the new mesh,
+  // which setup_system() completes. p4est refines additional cells so that
+  // neighboring cells still differ by at most one level.
+  //
+  // In hp refinement, the smoothness of the solution on a marked cell is
+  // estimated from the decay of the coefficients of its expansion into
+  // Legendre polynomials. The cells marked for refinement whose smoothness
+  // lies in the upper fifth of the range over these cells get the next
+  // higher degree instead of being split, and the cells marked for
+  // coarsening whose smoothness lies in the lower fifth the next lower
+  // degree instead of being merged.
+  template <int dim, typename LinearAlgebra>
+  void BiLaplacianLDGLift<dim, LinearAlgebra>::refine_grid()
+  {
+    pcout << "Refining the mesh............." << std::endl;
+
+    if (parameters.refinement != "global")
+      parallel::distributed::GridRefinement::refine_and_coarsen_fixed_number(
+        triangulation,
+        estimated_error_per_cell,
+        parameters.refine_fraction,
+        parameters.coarsen_fraction);
+    else
+      for (const auto &cell : triangulation.active_cell_iterators())
+        if (cell->is_locally_owned())
+          cell->set_refine_flag();
+
+    if (parameters.refinement == "hp" && fe.size() > 1)
+      {
+        if (!legendre)
+          legendre = std::make_unique<FESeries::Legendre<dim>>(
+            SmoothnessEstimator::Legendre::default_fe_series(fe));
+
+        Vector<float> smoothness_indicators(triangulation.n_active_cells());
+        SmoothnessEstimator::Legendre::coefficient_decay(
+          *legendre,
+          dof_handler,
+          locally_relevant_solution,
+          smoothness_indicators);
+
+        hp::Refinement::p_adaptivity_from_relative_threshold(
+          dof_handler, smoothness_indicators, 0.2, 0.2);
+        hp::Refinement::choose_p_over_h(dof_handler);
+      }
+
+    triangulation.prepare_coarsening_and_refinement();
+
+    solution_transfer =
+      std::make_unique<parallel::distributed::SolutionTransfer<
+        dim,
+        dealii::LinearAlgebra::distributed::Vector<double>>>(dof_handler);
+    solution_transfer->prepare_for_coarsening_and_refinement(
+      locally_relevant_solution);
+
+    // The active cell indices and the numbering of the DoFs change with the
+    // mesh, the cell ids of the cells that are not refined or coarsened do
+    // not.
+    if (parameters.incremental_assembly)
+      {
+        Timer timer;
+        store_cell_matrix_rows();
+        timer.stop();
+        store_rows_time = timer.wall_time();
+      }
+
+    triangulation.execute_coarsening_and_refinement();
+
+    pcout << "Number of active cells: "
+          << triangulation.n_global_active_cells() << std::endl;
+  }
+
+
+
+  // Keep the rows of the matrix and the right hand side of the locally
+  // owned cells by cell id before the mesh changes. The rows of a cell can
+  // only be copied if the cell and its neighbors are locally owned and are
+  // neither refined, coarsened nor given another degree, so only those are
+  // kept; the cell and its neighbors are recorded for all cells to tell
+  // which cells are unchanged, see find_reused_matrix_rows(). The columns
+  // of a row all belong to the cells up to two faces away, see
+  // setup_system(), and are sorted into the block of their cell.
+  template <int dim, typename LinearAlgebra>
+  void BiLaplacianLDGLift<dim, LinearAlgebra>::store_cell_matrix_rows()
+  {
+    previous_cell_matrix_rows.clear();
+    previous_cell_rhs.clear();
+
+    const auto is_changed =
+      [](const typename DoFHandler<dim>::active_cell_iterator &cell) {
+        return cell->refine_flag_set() || cell->coarsen_flag_set() ||
+               cell->future_fe_index_set();
+      };
+
+    using Column =
+      std::pair<types::global_dof_index, std::pair<unsigned int, unsigned int>>;
+
+    std::vector<FaceNeighbor<dim>>                              neighbors;
+    std::vector<typename DoFHandler<dim>::active_cell_iterator> two_ring;
+    std::vector<types::global_dof_index>                        dof_indices;
+    std::vector<types::global_dof_index> column_dof_indices;
+    std::vector<Column>                  columns;
+
+    for (const auto &cell : dof_handler.active_cell_iterators())
+      if (cell->is_locally_owned())
+        {
+          const unsigned int n_dofs = cell->get_fe().n_dofs_per_cell();
+          dof_indices.resize(n_dofs);
+          cell->get_dof_indices(dof_indices);
+
+          if (!is_changed(cell))
+            {
+              std::pair<unsigned int, Vector<double>> &cell_rhs =
+                previous_cell_rhs[cell->id()];
+              cell_rhs.first = cell->active_fe_index();
+              cell_rhs.second.reinit(n_dofs);
+              rhs.extract_subvector_to(dof_indices.begin(),
+                                       dof_indices.end(),
+                                       cell_rhs.second.begin());
+            }
+
+          CellMatrixRows &rows = previous_cell_matrix_rows[cell->id()];
+
+          get_face_neighbors(cell, neighbors);
+          rows.cells.emplace_back(cell->id(), cell->active_fe_index());
+          bool copyable = !is_changed(cell);
+          for (const auto &neighbor : neighbors)
+            {
+              rows.cells.emplace_back(neighbor.cell->id(),
+                                      neighbor.cell->active_fe_index());
+              if (!neighbor.cell->is_locally_owned() ||
+                  is_changed(neighbor.cell))
+                copyable = false;
+            }
+          if (!copyable)
+            continue;
+
+          get_two_ring(cell, neighbors, two_ring);
+          columns.clear();
+          rows.blocks.resize(two_ring.size());
+          for (unsigned int c = 0; c < two_ring.size(); ++c)
+            {
+              column_dof_indices.resize(
+                two_ring[c]->get_fe().n_dofs_per_cell());
+              two_ring[c]->get_dof_indices(column_dof_indices);
+              for (unsigned int j = 0; j < column_dof_indices.size(); ++j)
+                columns.emplace_back(column_dof_indices[j],
+                                     std::make_pair(c, j));
+              rows.blocks[c].reinit(n_dofs, column_dof_indices.size());
+            }
+          std::sort(columns.begin(), columns.end());
+
+          for (unsigned int i = 0; i < n_dofs; ++i)
+            for (auto entry = matrix.begin(dof_indices[i]);
+                 entry != matrix.end(dof_indices[i]);
+                 ++entry)
+              {
+                const types::global_dof_index j = entry->column();
+                const auto                    column = std::lower_bound(
+                  columns.begin(),
+                  columns.end(),
+                  j,
+                  [](const Column &column, const types::global_dof_index j) {
+                    return column.first < j;
+                  });
+                Assert(column != columns.end() && column->first == j,
+                       ExcInternalError());
+                rows.blocks[column->second.first](i, column->second.second) =
+                  entry->value();
+              }
+        }
+  }
+
+
+
+  // Compute the support points of the mapping on all cells of the current
+  // mesh. The collection copies the mapping including its cache, so it is
+  // rebuilt as well. Only the support points are cached: the Jacobians,
+  // their inverses and gradients, and the normals are computed from them
+  // again whenever FEValues is initialized on a cell, i.e. several times
+  // per cell in the assembly and again in every later pass over the cells.
+  template <int dim, typename LinearAlgebra>
+  void BiLaplacianLDGLift<dim, LinearAlgebra>::setup_mapping()
+  {
+    mapping.initialize(MappingQGeneric<dim>(parameters.mapping_degree),
+                       triangulation);
+    mapping_collection = hp::MappingCollection<dim>(mapping);
+  }
+
+
+
+  // The default numbering of the degrees of freedom follows the refinement
+  // hierarchy: the cells are numbered coarse cell by coarse cell and child
+  // by child, so cells on either side of the boundary between two coarse
+  // cells, or between two children of a coarse cell, get indices far apart.
+  // The matrix assembly accesses every cell together with its neighbors and
+  // pairs of its neighbors, and a row of the matrix couples the degrees of
+  // freedom of the cells up to two faces away, so these blocks then lie far
+  // apart in the matrix and the vectors. With the Hilbert ordering, the
+  // degrees of freedom of every process are instead numbered cell by cell,
+  // and the cells are ordered along a Hilbert curve through their centers,
+  // which keeps cells close in space close in memory across all levels.
+  // When overlapping communication, the halo cells come first, so that the
+  // rows of every chunk, which is a range of consecutive cells, are
+  // contiguous for both kinds of chunks.
+  template <int dim, typename LinearAlgebra>
+  void BiLaplacianLDGLift<dim, LinearAlgebra>::renumber_dofs()
+  {
+    owned_cells.clear();
+    for (const auto &cell : dof_handler.active_cell_iterators())
+      if (cell->is_locally_owned())
+        owned_cells.push_back(cell);
+
+    if (parameters.dof_ordering == "hilbert" && !owned_cells.empty())
+      {
+        std::vector<Point<dim>> centers;
+        centers.reserve(owned_cells.size());
+        for (const auto &cell : owned_cells)
+          centers.push_back(cell->center());
+
+        // The library returns the Hilbert index of every cell as dim
+        // integers of bits_per_dim bits each, the most significant part
+        // first, not in Skilling's transposed form whose bits would have to
+        // be interleaved. The cells are therefore in the order along the
+        // curve if sorted lexicographically by these arrays.
+        const int bits_per_dim = 64 / dim;
+        const std::vector<std::array<std::uint64_t, dim>> hilbert_indices =
+          Utilities::inverse_Hilbert_space_filling_curve(centers,
+                                                         bits_per_dim);
+
+        std::vector<std::pair<std::array<std::uint64_t, dim>, unsigned int>>
+          keys(owned_cells.size());
+        for (unsigned int c = 0; c < owned_cells.size(); ++c)
+          keys[c] = {hilbert_indices[c], c};
+        std::sort(keys.begin(), keys.end());
+
+        const CellChunk cells_in_default_order = owned_cells;
+        for (unsigned int c = 0; c < keys.size(); ++c)
+          owned_cells[c] = cells_in_default_order[keys[c].second];
+      }
+
+    // The order of the cells only matters for the numbering; the chunks of
+    // setup_cell_chunks() select the halo cells by themselves.
+    if (parameters.overlap_communication &&
+        parameters.dof_ordering != "default")
+      std::stable_partition(
+        owned_cells.begin(),
+        owned_cells.end(),
+        [this](const typename DoFHandler<dim>::active_cell_iterator &cell) {
+          return is_halo_cell(cell);
+        });
+
+    if (parameters.dof_ordering != "default")
+      DoFRenumbering::cell_wise(dof_handler, owned_cells);
+  }
+
+
+
+  template <int dim, typename LinearAlgebra>
+  void BiLaplacianLDGLift<dim, LinearAlgebra>::setup_system()
+  {
+    setup_mapping();
+
+    dof_handler.distribute_dofs(fe);
+    renumber_dofs();
+
+    pcout << "Number of degrees of freedom: " << dof_handler.n_dofs()
+          << std::endl;
+
+    locally_owned_dofs = dof_handler.locally_owned_dofs();
+    DoFTools::extract_locally_relevant_dofs(dof_handler, locally_relevant_dofs);
+    locally_owned_dofs_per_process =
+      Utilities::MPI::all_gather(mpi_communicator, locally_owned_dofs);
+    off_process_exchange.processes.assign(
+      triangulation.ghost_owners().begin(), triangulation.ghost_owners().end());
+
+    // The entries generated by a locally owned cell live in the rows of the
+    // cell and of its neighbors, i.e. in locally relevant rows. The rows
+    // owned by other processes are then sent to their owners.
+    DynamicSparsityPattern dsp(locally_relevant_dofs);
+
+    std::vector<FaceNeighbor<dim>> neighbors;
+
+    for (const auto &cell : dof_handler.active_cell_iterators())
+      if (cell->is_locally_owned())
+        {
+          std::vector<types::global_dof_index> dofs(
+            cell->get_fe().n_dofs_per_cell());
+          cell->get_dof_indices(dofs);
+
+          get_face_neighbors(cell, neighbors);
+          for (const auto &neighbor : neighbors)
+            {
+              std::vector<types::global_dof_index> tmp(
+                neighbor.cell->get_fe().n_dofs_per_cell());
+              neighbor.cell->get_dof_indices(tmp);
+
+              dofs.insert(std::end(dofs), std::begin(tmp), std::end(tmp));
+            }
+
+          for (const auto i : dofs)
+            for (const auto j : dofs)
+              {
+                dsp.add(i, j);
+                dsp.add(j, i);
+              }
+        }
+
+    SparsityTools::distribute_sparsity_pattern(dsp,
+                                               locally_owned_dofs,
+                                               mpi_communicator,
+                                               locally_relevant_dofs);
+
+    setup_cell_chunks();
+    if (colored_assembly())
+      setup_cell_colors();
+
+    LinearAlgebra::reinit_matrix(
+      matrix, sparsity_pattern, locally_owned_dofs, dsp, mpi_communicator);
+
+    // A row couples the DoFs of a cell with those of the cells up to two
+    // faces away, which are 13 cells in 2D and 25 in 3D on a uniform mesh,
+    // with several times as many DoFs per cell in 3D. The size of the
+    // matrix therefore grows much faster with the degree in 3D.
+    pcout << "Number of nonzero entries of the matrix: "
+          << matrix.n_nonzero_elements() << std::endl;
+    LinearAlgebra::reinit_vector(rhs,
+                                 locally_owned_dofs,
+                                 IndexSet(),
+                                 mpi_communicator);
+
+    LinearAlgebra::reinit_vector(solution,
+                                 locally_owned_dofs,
+                                 IndexSet(),
+                                 mpi_communicator);
+    locally_relevant_solution.reinit(locally_owned_dofs,
+                                     locally_relevant_dofs,
+                                     mpi_communicator);
+    if (LinearAlgebra::threaded_first_touch)
+      {
+        first_touch(rhs);
+        first_touch(solution);
+      }
+
+    // After a refinement, the solution on the previous mesh is the initial
+    // guess of the iterative solver.
+    if (solution_transfer)
+      {
+        dealii::LinearAlgebra::distributed::Vector<double> transferred_solution(
+          locally_owned_dofs, mpi_communicator);
+        solution_transfer->interpolate(transferred_solution);
+        solution_transfer.reset();
+
+        for (const auto i : locally_owned_dofs)
+          solution(i) = transferred_solution(i);
+        solution.compress(VectorOperation::insert);
+      }
+
+    estimated_error_per_cell.reinit(triangulation.n_active_cells());
+
+    // The sparsity pattern is only printed if the whole matrix is stored on
+    // a single process. Like the files of every process, it is written by
+    // the background writer if there is one, from a copy.
+    if (!quiet && Utilities::MPI::n_mpi_processes(mpi_communicator) == 1)
+      {
+        const auto sparsity_pattern_copy = std::make_shared<SparsityPattern>();
+        sparsity_pattern_copy->copy_from(dsp);
+
+        const auto write_svg = [sparsity_pattern_copy]() {
+          std::ofstream out("sparsity_pattern.svg");
+          sparsity_pattern_copy->print_svg(out);
+          return static_cast<double>(out.tellp());
+        };
+        if (background_writer)
+          background_writer->submit("sparsity_pattern.svg", write_svg);
+        else
+          write_svg();
+      }
+  }
+
+
+
+  // The estimated cost of a cell with n_dofs_per_cell degrees of freedom,
+  // relative to the cost of a cell of the lowest degree all of whose faces
+  // are interior and not refined. The cost grows with the number of
+  // neighbors, of which a refined face has one per child, and every block
+  // costs the product of the numbers of degrees of freedom of the two cells
+  // it couples and of the quadrature points, which grow alike with the
+  // degree. Measured costs from a previous run are used instead if
+  // available for this cell.
+  template <int dim, typename LinearAlgebra>
+  double BiLaplacianLDGLift<dim, LinearAlgebra>::cell_cost(
+    const CellAccessor<dim> &cell,
+    const unsigned int       n_dofs_per_cell) const
+  {
+    if (parameters.cell_cost_model == "uniform")
+      return 1.0;
+
+    if (parameters.cell_cost_model == "measured")
+      {
+        const auto entry = measured_cell_costs.find(cell.id());
+        if (entry != measured_cell_costs.end())
+          return entry->second;
+      }
+
+    const auto block_cost = [](const double n_neighbors) {
+      return 1.0 + 4.0 * n_neighbors + n_neighbors * (n_neighbors - 1.0);
+    };
+
+    unsigned int n_neighbors = 0;
+    for (const unsigned int f : cell.face_indices())
+      if (!cell.at_boundary(f))
+        n_neighbors +=
+          (cell.face(f)->has_children() ? cell.face(f)->n_children() : 1);
+
+    const double dofs_ratio =
+      static_cast<double>(n_dofs_per_cell) / fe[0].n_dofs_per_cell();
+
+    return std::pow(dofs_ratio, 3) * block_cost(n_neighbors) /
+           block_cost(GeometryInfo<dim>::faces_per_cell);
+  }
+
+
+
+  // Read the cell costs written by write_cell_costs() in a previous run. All
+  // processes read the whole file, since the cells are not necessarily
+  // owned by the same processes as in the previous run.
+  template <int dim, typename LinearAlgebra>
+  void BiLaplacianLDGLift<dim, LinearAlgebra>::read_cell_costs()
+  {
+    std::ifstream in(parameters.cell_cost_input_file);
+    AssertThrow(in, ExcFileNotOpen(parameters.cell_cost_input_file));
+
+    measured_cell_costs.clear();
+
+    std::string line;
+    while (std::getline(in, line))
+      {
+        std::istringstream line_stream(line);
+        std::string        cell_id;
+        double             cost;
+        if (line_stream >> cell_id >> cost)
+          measured_cell_costs[CellId(cell_id)] = cost;
+      }
+
+    pcout << "Read measured costs of " << measured_cell_costs.size()
+          << " cells." << std::endl;
+  }
+
+
+
+  // Write the assembly time of every locally owned cell, relative to the
+  // average over all cells, to the file given in the parameter file. The
+  // data is collected on the first process, which writes the file.
+  template <int dim, typename LinearAlgebra>
+  void BiLaplacianLDGLift<dim, LinearAlgebra>::write_cell_costs() const
+  {
+    std::vector<std::pair<std::string, double>> local_costs;
+    for (const auto &cell : dof_handler.active_cell_iterators())
+      if (cell->is_locally_owned())
+        local_costs.emplace_back(
+          cell->id().to_string(),
+          cell_assembly_times(cell->active_cell_index()));
+
+    const std::vector<std::vector<std::pair<std::string, double>>>
+      all_costs = Utilities::MPI::gather(mpi_communicator, local_costs, 0);
+
+    if (Utilities::MPI::this_mpi_process(mpi_communicator) != 0)
+      return;
+
+    double       total_time = 0;
+    unsigned int n_cells    = 0;
+    for (const auto &costs : all_costs)
+      for (const auto &cost : costs)
+        {
+          total_time += cost.second;
+          ++n_cells;
+        }
+
+    const double average_time = (n_cells > 0 ? total_time / n_cells : 1.0);
+
+    std::ofstream out(parameters.cell_cost_output_file);
+    for (const auto &costs : all_costs)
+      for (const auto &cost : costs)
+        out << cost.first << ' ' << cost.second / average_time << '\n';
+  }
+
+
+
+  // Split the locally owned cells into chunks of approximately equal cost,
+  // which are the units of work of the threads during the matrix assembly.
+  // There are several chunks per thread, so that the scheduler can still
+  // balance the remaining differences. The cells of a chunk are consecutive,
+  // which keeps the data of neighboring cells together. When overlapping
+  // communication, the halo cells next to other processes are put into
+  // chunks of their own, which come first.
+  template <int dim, typename LinearAlgebra>
+  void BiLaplacianLDGLift<dim, LinearAlgebra>::setup_cell_chunks()
+  {
+    cell_assembly_times.reinit(triangulation.n_active_cells());
+
+    double local_cost = 0;
+    for (const auto &cell : dof_handler.active_cell_iterators())
+      if (cell->is_locally_owned())
+        local_cost += cell_cost(*cell, cell->get_fe().n_dofs_per_cell());
+
+    const unsigned int n_chunks_per_thread = 8;
+    const double       chunk_cost =
+      local_cost / (n_chunks_per_thread * MultithreadInfo::n_threads());
+
+    cell_chunks.clear();
+    const auto add_cells_to_chunks = [this, chunk_cost](const bool halo) {
+      cell_chunks.emplace_back();
+      double current_cost = 0;
+      for (const auto &cell : owned_cells)
+        if (!parameters.overlap_communication || is_halo_cell(cell) == halo)
+          {
+            if (current_cost >= chunk_cost && !cell_chunks.back().empty())
+              {
+                cell_chunks.emplace_back();
+                current_cost = 0;
+              }
+
+            cell_chunks.back().push_back(cell);
+            current_cost +=
+              cell_cost(*cell, cell->get_fe().n_dofs_per_cell());
+          }
+      if (cell_chunks.back().empty())
+        cell_chunks.pop_back();
+    };
+
+    if (parameters.overlap_communication)
+      add_cells_to_chunks(/*halo=*/true);
+    n_halo_chunks = cell_chunks.size();
+    add_cells_to_chunks(/*halo=*/false);
+
+    const Utilities::MPI::MinMaxAvg cost_statistics =
+      Utilities::MPI::min_max_avg(local_cost, mpi_communicator);
+    pcout << "Estimated load imbalance between processes (max/avg): "
+          << (cost_statistics.avg > 0 ?
+                cost_statistics.max / cost_statistics.avg :
+                1.0)
+          << std::endl;
+  }
+
+
+
+  // The operating system places a page of memory on the NUMA domain of the
+  // thread that writes to it first. With "Parallel first touch", the entries
+  // of the vectors are zeroed by all threads, in about as many contiguous
+  // ranges as there are threads, so that their pages are spread over the
+  // domains of the threads instead of all lying on that of the main thread.
+  // This balances the memory traffic between the domains, much like
+  // interleaving the pages. It does not place a page near the thread that
+  // later works on it: this loop, the assembly and the matrix-vector
+  // products each hand out their work to the threads dynamically. deal.II
+  // zeroes a SparseMatrix on all threads as well when it is initialized.
+  template <int dim, typename LinearAlgebra>
+  void BiLaplacianLDGLift<dim, LinearAlgebra>::first_touch(
+    typename LinearAlgebra::Vector &vector) const
+  {
+    const unsigned int size = vector.size();
+    if (!parameters.parallel_first_touch)
+      {
+        for (unsigned int i = 0; i < size; ++i)
+          vector(i) = 0.;
+        return;
+      }
+
+    const unsigned int n_threads = MultithreadInfo::n_threads();
+    parallel::apply_to_subranges(
+      0U,
+      size,
+      [&vector](const unsigned int begin, const unsigned int end) {
+        for (unsigned int i = begin; i < end; ++i)
+          vector(i) = 0.;
+      },
+      std::max(1U, (size + n_threads - 1) / n_threads));
+  }
+
+
+
+  // The colored schedule needs a matrix that several threads may add to at
+  // the same time, which only the deal.II backend provides. With the other
+  // backends, the matrix is assembled in chunks, see the warning in the
+  // constructor.
+  template <int dim, typename LinearAlgebra>
+  bool BiLaplacianLDGLift<dim, LinearAlgebra>::colored_assembly() const
+  {
+    return parameters.assembly_schedule == "colored" &&
+           LinearAlgebra::concurrent_add;
+  }
+
+
+
+  // Two cells must not add to the matrix at the same time if they write to
+  // the same rows. A cell writes to its own rows and to those of its face
+  // neighbors (the blocks coupling two neighbors of the cell are in the rows
+  // of one of them), so two cells conflict if these sets of cells overlap,
+  // i.e. if the cells are at most two faces apart. This is a larger set of
+  // conflicts than the face neighbors alone. The cells are colored such
+  // that no two cells of the same color conflict.
+  template <int dim, typename LinearAlgebra>
+  void BiLaplacianLDGLift<dim, LinearAlgebra>::setup_cell_colors()
+  {
+    Assert(colored_assembly(), ExcInternalError());
+
+    cell_colors = GraphColoring::make_graph_coloring(
+      CellFilter(IteratorFilters::LocallyOwnedCell(),
+                 dof_handler.begin_active()),
+      CellFilter(IteratorFilters::LocallyOwnedCell(), dof_handler.end()),
+      [](const CellFilter &cell) {
+        std::vector<FaceNeighbor<dim>> neighbors;
+        get_face_neighbors<dim>(cell, neighbors);
+
+        std::vector<types::global_dof_index> written_cells(
+          1, cell->active_cell_index());
+        for (const auto &neighbor : neighbors)
+          written_cells.push_back(neighbor.cell->active_cell_index());
+        std::sort(written_cells.begin(), written_cells.end());
+        return written_cells;
+      });
+
+    pcout << "Number of colors: " << cell_colors.size() << std::endl;
+  }
+
+
+
+  // A halo cell is a locally owned cell with a neighbor owned by another
+  // process. Its contributions to the matrix include rows owned by that
+  // process, and its errors depend on values of the solution on the ghost
+  // cell.
+  template <int dim, typename LinearAlgebra>
+  bool BiLaplacianLDGLift<dim, LinearAlgebra>::is_halo_cell(
+    const typename DoFHandler<dim>::active_cell_iterator &cell) const
+  {
+    std::vector<FaceNeighbor<dim>> neighbors;
+    get_face_neighbors(cell, neighbors);
+
+    for (const auto &neighbor : neighbors)
+      if (!neighbor.cell->is_locally_owned())
+        return true;
+    return false;
+  }
+
+
+
+  template <int dim, typename LinearAlgebra>
+  void BiLaplacianLDGLift<dim, LinearAlgebra>::assemble_system()
+  {
+    pcout << "Assembling the system............." << std::endl;
+
+    n_reused_cells     = 0;
+    n_recomputed_cells = 0;
+    n_reused_rhs_cells = 0;
+
+    Timer matrix_timer;
+    {
+      TimerOutput::Scope t(computing_timer, "Assemble matrix");
+      if (parameters.incremental_assembly)
+        find_reused_matrix_rows();
+      assemble_matrix();
+    }
+    matrix_timer.stop();
+    if (!parameters.cell_cost_output_file.empty())
+      write_cell_costs();
+    {
+      TimerOutput::Scope t(computing_timer, "Assemble rhs");
+      assemble_rhs();
+    }
+
+    if (parameters.incremental_assembly)
+      {
+        previous_cell_matrix_rows.clear();
+        previous_cell_rhs.clear();
+        pcout << "   Copied the matrix rows of "
+              << Utilities::MPI::sum(n_reused_cells.load(), mpi_communicator)
+              << " and the right hand side of "
+              << Utilities::MPI::sum(n_reused_rhs_cells.load(),
+                                     mpi_communicator)
+              << " of " << triangulation.n_global_active_cells()
+              << " cells, computed "
+              << Utilities::MPI::sum(n_recomputed_cells.load(),
+                                     mpi_communicator)
+              << " cells again" << std::endl
+              << "   Wall time of the matrix assembly: "
+              << Utilities::MPI::max(matrix_timer.wall_time(),
+                                     mpi_communicator)
+              << " s, of the copy of the rows before the refinement: "
+              << Utilities::MPI::max(store_rows_time, mpi_communicator)
+              << " s" << std::endl;
+        store_rows_time = 0;
+      }
+
+    pcout << "Done. " << std::endl;
+  }
+
+
+
+  template <int dim, typename LinearAlgebra>
+  void BiLaplacianLDGLift<dim, LinearAlgebra>::assemble_matrix()
+  {
+    if (colored_assembly())
+      {
+        assemble_matrix_colored();
+        return;
+      }
+
+    matrix = 0;
+    off_process_entries.clear();
+
+    const hp::QCollection<dim> &    quad      = reference_data->quad;
+    const hp::QCollection<dim - 1> &quad_face = reference_data->quad_face;
+
+    using ChunkIterator = typename std::vector<CellChunk>::const_iterator;
+
+    // Every work item is one of the cost-balanced chunks of cells set up in
+    // setup_cell_chunks(). The time spent on each cell is recorded, so that
+    // it can be used as the cost of the cell in a later run.
+    const auto assemble_chunks = [&](const ChunkIterator &begin,
+                                     const ChunkIterator &end) {
+      WorkStream::run(
+        begin,
+        end,
+        [this](const ChunkIterator &             chunk,
+               Assembly::Scratch::Matrix<dim> &scratch_data,
+               Assembly::CopyData::Matrix &    copy_data) {
+          copy_data.reset();
+          for (const auto &cell : *chunk)
+            {
+              const auto start = std::chrono::steady_clock::now();
+              local_assemble_matrix(cell, scratch_data, copy_data);
+              cell_assembly_times(cell->active_cell_index()) =
+                std::chrono::duration<double>(
+                  std::chrono::steady_clock::now() - start)
+                  .count();
+            }
+        },
+        [this](const Assembly::CopyData::Matrix &copy_data) {
+          copy_local_to_global_matrix(copy_data);
+        },
+        Assembly::Scratch::Matrix<dim>(
+          mapping_collection, fe, fe_lift, quad, quad_face),
+        Assembly::CopyData::Matrix(),
+        2 * MultithreadInfo::n_threads(),
+        1);
+    };
+
+    // When overlapping communication, the halo chunks come first. Once they
+    // are assembled, all entries for other processes are known and can be
+    // sent while the remaining chunks are assembled. Otherwise, there are no
+    // halo chunks and the entries are sent after the loop.
+    const ChunkIterator first_interior_chunk =
+      cell_chunks.cbegin() + n_halo_chunks;
+
+    assemble_chunks(cell_chunks.cbegin(), first_interior_chunk);
+    if (parameters.overlap_communication)
+      {
+        TimerOutput::Scope t(computing_timer,
+                             "Assemble matrix: communication");
+        start_off_process_exchange();
+      }
+
+    assemble_chunks(first_interior_chunk, cell_chunks.cend());
+    if (parameters.overlap_communication || parameters.deterministic)
+      {
+        TimerOutput::Scope t(computing_timer,
+                             "Assemble matrix: communication");
+        if (!parameters.overlap_communication)
+          start_off_process_exchange();
+        finish_off_process_exchange();
+      }
+
+    // Otherwise the entries computed in rows owned by other processes are
+    // sent to their owners here.
+    matrix.compress(VectorOperation::add);
+  }
+
+
+
+  // Assemble the matrix color by color. Within a color, the cells are
+  // distributed over the threads and every thread adds the contributions of
+  // its cells to the matrix itself, without any locks. Every color is timed
+  // separately to report its parallel efficiency: the time spent in its
+  // cells divided by its wall time and the number of threads. Colors with
+  // few cells, typically the last ones, leave threads idle. The order of
+  // the additions into every entry is given by the colors, so the result
+  // is the same in every run.
+  template <int dim, typename LinearAlgebra>
+  void BiLaplacianLDGLift<dim, LinearAlgebra>::assemble_matrix_colored()
+  {
+    matrix = 0;
+
+    const Assembly::Scratch::Matrix<dim> sample_scratch_data(
+      mapping_collection,
+      fe,
+      fe_lift,
+      reference_data->quad,
+      reference_data->quad_face);
+
+    pcout << "   Color     Cells   Wall time   Efficiency" << std::endl;
+
+    for (unsigned int color = 0; color < cell_colors.size(); ++color)
+      {
+        const auto start = std::chrono::steady_clock::now();
+
+        WorkStream::run(
+          std::vector<std::vector<CellFilter>>(1, cell_colors[color]),
+          [this](const CellFilter &                cell,
+                 Assembly::Scratch::Matrix<dim> &scratch_data,
+                 Assembly::CopyData::Matrix &    copy_data) {
+            const auto start = std::chrono::steady_clock::now();
+            copy_data.reset();
+            local_assemble_matrix(cell, scratch_data, copy_data);
+            cell_assembly_times(cell->active_cell_index()) =
+              std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                            start)
+                .count();
+          },
+          [this](const Assembly::CopyData::Matrix &copy_data) {
+            copy_local_to_global_matrix(copy_data);
+          },
+          sample_scratch_data,
+          Assembly::CopyData::Matrix());
+
+        const double wall_time =
+          std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                        start)
+            .count();
+
+        double cell_time = 0;
+        for (const auto &cell : cell_colors[color])
+          cell_time += cell_assembly_times(cell->active_cell_index());
+
+        pcout << std::setw(8) << color << std::setw(10)
+              << cell_colors[color].size() << std::setw(12) << wall_time
+              << std::setw(13)
+              << cell_time / (MultithreadInfo::n_threads() * wall_time)
+              << std::endl;
+      }
+
+    matrix.compress(VectorOperation::add);
+  }
+
+
+
+  // WorkStream calls the copier for the chunks in their order, so the
+  // contributions of the locally owned cells are added in the same order
+  // in every run, whatever the number of threads. The entries for other
+  // processes are, however, added by the libraries in the order in which
+  // the messages arrive during compress(). In the deterministic mode and
+  // when overlapping communication, they are therefore exchanged by the
+  // following three functions and added in the order of the sending
+  // processes, after the local contributions. This costs one call of add()
+  // per received entry.
+  template <int dim, typename LinearAlgebra>
+  void BiLaplacianLDGLift<dim, LinearAlgebra>::start_off_process_exchange()
+  {
+    OffProcessExchange &exchange    = off_process_exchange;
+    const unsigned int  n_processes = exchange.processes.size();
+
+    exchange.send_sizes.resize(n_processes);
+    exchange.receive_sizes.resize(n_processes);
+    exchange.send_buffers.resize(n_processes);
+    exchange.receive_buffers.resize(n_processes);
+    exchange.send_requests.assign(2 * n_processes, MPI_REQUEST_NULL);
+    exchange.size_requests.assign(n_processes, MPI_REQUEST_NULL);
+    exchange.receive_requests.assign(n_processes, MPI_REQUEST_NULL);
+    exchange.receive_posted.assign(n_processes, false);
+
+    for (const auto &entries : off_process_entries)
+      {
+        (void)entries;
+        Assert(std::find(exchange.processes.begin(),
+                         exchange.processes.end(),
+                         entries.first) != exchange.processes.end(),
+               ExcInternalError());
+      }
+
+    for (unsigned int k = 0; k < n_processes; ++k)
+      {
+        const unsigned int process = exchange.processes[k];
+
+        exchange.send_buffers[k] =
+          Utilities::pack(off_process_entries[process],
+                          /*allow_compression=*/false);
+        exchange.send_sizes[k] = exchange.send_buffers[k].size();
+
+        int ierr = MPI_Isend(&exchange.send_sizes[k],
+                             1,
+                             MPI_UNSIGNED_LONG_LONG,
+                             process,
+                             OffProcessExchange::size_tag,
+                             mpi_communicator,
+                             &exchange.send_requests[2 * k]);
+        AssertThrowMPI(ierr);
+        ierr = MPI_Isend(exchange.send_buffers[k].data(),
+                         static_cast<int>(exchange.send_sizes[k]),
+                         MPI_CHAR,
+                         process,
+                         OffProcessExchange::data_tag,
+                         mpi_communicator,
+                         &exchange.send_requests[2 * k + 1]);
+        AssertThrowMPI(ierr);
+        ierr = MPI_Irecv(&exchange.receive_sizes[k],
+                         1,
+                         MPI_UNSIGNED_LONG_LONG,
+                         process,
+                         OffProcessExchange::size_tag,
+                         mpi_communicator,
+                         &exchange.size_requests[k]);
+        AssertThrowMPI(ierr);
+      }
+
+    off_process_entries.clear();
+    exchange.in_progress = true;
+  }
+
+
+
+  // Post the receive of every message whose size has arrived. This is called
+  // by the copier while the interior cells are assembled, which also gives
+  // MPI the opportunity to move the messages on. Only one thread at a time
+  // runs the copier, as MPI requires.
+  template <int dim, typename LinearAlgebra>
+  void BiLaplacianLDGLift<dim, LinearAlgebra>::progress_off_process_exchange()
+  {
+    OffProcessExchange &exchange = off_process_exchange;
+
+    for (unsigned int k = 0; k < exchange.processes.size(); ++k)
+      if (!exchange.receive_posted[k])
+        {
+          int size_arrived = 0;
+          int ierr         = MPI_Test(&exchange.size_requests[k],
+                              &size_arrived,
+                              MPI_STATUS_IGNORE);
+          AssertThrowMPI(ierr);
+          if (!size_arrived)
+            continue;
+
+          exchange.receive_buffers[k].resize(exchange.receive_sizes[k]);
+          ierr = MPI_Irecv(exchange.receive_buffers[k].data(),
+                           static_cast<int>(exchange.receive_sizes[k]),
+                           MPI_CHAR,
+                           exchange.processes[k],
+                           OffProcessExchange::data_tag,
+                           mpi_communicator,
+                           &exchange.receive_requests[k]);
+          AssertThrowMPI(ierr);
+          exchange.receive_posted[k] = true;
+        }
+  }
+
+
+
+  template <int dim, typename LinearAlgebra>
+  void BiLaplacianLDGLift<dim, LinearAlgebra>::finish_off_process_exchange()
+  {
+    OffProcessExchange &exchange = off_process_exchange;
+
+    int ierr = MPI_Waitall(exchange.size_requests.size(),
+                           exchange.size_requests.data(),
+                           MPI_STATUSES_IGNORE);
+    AssertThrowMPI(ierr);
+    progress_off_process_exchange();
+
+    ierr = MPI_Waitall(exchange.receive_requests.size(),
+                       exchange.receive_requests.data(),
+                       MPI_STATUSES_IGNORE);
+    AssertThrowMPI(ierr);
+
+    // The processes are sorted, so the entries are added in the order of
+    // the sending processes.
+    for (const auto &buffer : exchange.receive_buffers)
+      {
+        const auto entries = Utilities::unpack<
+          std::pair<std::vector<types::global_dof_index>,
+                    std::vector<double>>>(buffer,
+                                          /*allow_compression=*/false);
+        const std::vector<types::global_dof_index> &indices = entries.first;
+        const std::vector<double> &                 values  = entries.second;
+        for (unsigned int i = 0; i < values.size(); ++i)
+          matrix.add(indices[2 * i], indices[2 * i + 1], values[i]);
+      }
+
+    ierr = MPI_Waitall(exchange.send_requests.size(),
+                       exchange.send_requests.data(),
+                       MPI_STATUSES_IGNORE);
+    AssertThrowMPI(ierr);
+
+    exchange.in_progress = false;
+  }
+
+
+
+  template <int dim, typename LinearAlgebra>
+  void BiLaplacianLDGLift<dim, LinearAlgebra>::local_assemble_matrix(
+    const typename DoFHandler<dim>::active_cell_iterator &cell,
+    Assembly::Scratch::Matrix<dim> &                      scratch_data,
+    Assembly::CopyData::Matrix &                          copy_data)
+  {
+    hp::FEFaceValues<dim> &   fe_face_neighbor = scratch_data.fe_face_neighbor;
+    hp::FESubfaceValues<dim> &fe_subface_neighbor =
+      scratch_data.fe_subface_neighbor;
+
+    scratch_data.fe_values.reinit(cell);
+    const FEValues<dim> &fe_values =
+      scratch_data.fe_values.get_present_fe_values();
+
+    const unsigned int n_q_points = fe_values.n_quadrature_points;
+
+    const unsigned int n_dofs = fe_values.dofs_per_cell;
+
+    std::vector<FaceNeighbor<dim>> &neighbors = scratch_data.neighbors;
+
+    std::vector<types::global_dof_index> &local_dof_indices =
+      scratch_data.local_dof_indices;
+    std::vector<types::global_dof_index> &local_dof_indices_neighbor =
+      scratch_data.local_dof_indices_neighbor;
+    std::vector<types::global_dof_index> &local_dof_indices_neighbor_2 =
+      scratch_data.local_dof_indices_neighbor_2;
+
+    FullMatrix<double> &stiffness_matrix_cc = scratch_data.stiffness_matrix_cc;
+    FullMatrix<double> &stiffness_matrix_cn = scratch_data.stiffness_matrix_cn;
+    FullMatrix<double> &stiffness_matrix_nc = scratch_data.stiffness_matrix_nc;
+    FullMatrix<double> &stiffness_matrix_nn = scratch_data.stiffness_matrix_nn;
+    FullMatrix<double> &stiffness_matrix_n1n2 =
+      scratch_data.stiffness_matrix_n1n2;
+    FullMatrix<double> &stiffness_matrix_n2n1 =
+      scratch_data.stiffness_matrix_n2n1;
+
+    FullMatrix<double> &ip_matrix_cc = scratch_data.ip_matrix_cc;
+    FullMatrix<double> &ip_matrix_cn = scratch_data.ip_matrix_cn;
+    FullMatrix<double> &ip_matrix_nc = scratch_data.ip_matrix_nc;
+    FullMatrix<double> &ip_matrix_nn = scratch_data.ip_matrix_nn;
+
+    std::vector<std::vector<Tensor<2, dim>>> &discrete_hessians =
+      scratch_data.discrete_hessians;
+    std::vector<std::vector<std::vector<Tensor<2, dim>>>>
+      &discrete_hessians_neigh = scratch_data.discrete_hessians_neigh;
+
+    local_dof_indices.resize(n_dofs);
+    cell->get_dof_indices(local_dof_indices);
+    get_face_neighbors(cell, neighbors);
+
+    if (parameters.incremental_assembly &&
+        reuse_cell_matrix(cell, neighbors, copy_data))
+      return;
+    const unsigned int first_block = copy_data.n_blocks;
+    if (parameters.incremental_assembly)
+      ++n_recomputed_cells;
+
+    compute_discrete_hessians(cell,
+                              neighbors,
+                              scratch_data.lifting,
+                              discrete_hessians,
+                              discrete_hessians_neigh);
+
+    // The neighbors may have other polynomial degrees than the cell, so the
+    // blocks coupling the cell and a neighbor, or two neighbors, are
+    // rectangular and are resized for every pair of cells.
+    stiffness_matrix_cc.reinit(n_dofs, n_dofs);
+    for (unsigned int q = 0; q < n_q_points; ++q)
+      {
+        const double dx = fe_values.JxW(q);
+
+        for (unsigned int i = 0; i < n_dofs; ++i)
+          for (unsigned int j = 0; j < n_dofs; ++j)
+            {
+              const Tensor<2, dim> &H_i = discrete_hessians[i][q];
+              const Tensor<2, dim> &H_j = discrete_hessians[j][q];
+
+              stiffness_matrix_cc(i, j) += scalar_product(H_j, H_i) * dx;
+            }
+      }
+
+    copy_data.add(local_dof_indices, local_dof_indices, stiffness_matrix_cc);
+
+    for (unsigned int n = 0; n < neighbors.size(); ++n)
+      {
+        const unsigned int n_dofs_neigh =
+          neighbors[n].cell->get_fe().n_dofs_per_cell();
+
+        local_dof_indices_neighbor.resize(n_dofs_neigh);
+        neighbors[n].cell->get_dof_indices(local_dof_indices_neighbor);
+
+        stiffness_matrix_cn.reinit(n_dofs, n_dofs_neigh);
+        stiffness_matrix_nc.reinit(n_dofs_neigh, n_dofs);
+        stiffness_matrix_nn.reinit(n_dofs_neigh, n_dofs_neigh);
+        for (unsigned int q = 0; q < n_q_points; ++q)
+          {
+            const double dx = fe_values.JxW(q);
+
+            for (unsigned int i = 0; i < n_dofs; ++i)
+              for (unsigned int j = 0; j < n_dofs_neigh; ++j)
+                {
+                  const Tensor<2, dim> &H_i = discrete_hessians[i][q];
+                  const Tensor<2, dim> &H_j_neigh =
+                    discrete_hessians_neigh[n][j][q];
+
+                  stiffness_matrix_cn(i, j) +=
+                    scalar_product(H_j_neigh, H_i) * dx;
+                  stiffness_matrix_nc(j, i) +=
+                    scalar_product(H_i, H_j_neigh) * dx;
+                }
+
+            for (unsigned int i = 0; i < n_dofs_neigh; ++i)
+              for (unsigned int j = 0; j < n_dofs_neigh; ++j)
+                {
+                  const Tensor<2, dim> &H_i_neigh =
+                    discrete_hessians_neigh[n][i][q];
+                  const Tensor<2, dim> &H_j_neigh =
+                    discrete_hessians_neigh[n][j][q];
+
+                  stiffness_matrix_nn(i, j) +=
+                    scalar_product(H_j_neigh, H_i_neigh) * dx;
+                }
+          }
+
+        copy_data.add(local_dof_indices,
+                      local_dof_indices_neighbor,
+                      stiffness_matrix_cn);
+        copy_data.add(local_dof_indices_neighbor,
+                      local_dof_indices,
+                      stiffness_matrix_nc);
+        copy_data.add(local_dof_indices_neighbor,
+                      local_dof_indices_neighbor,
+                      stiffness_matrix_nn);
+      } // for neighbor
+
+    for (unsigned int n = 0; n < neighbors.size(); ++n)
+      for (unsigned int n_2 = n + 1; n_2 < neighbors.size(); ++n_2)
+        {
+          const unsigned int n_dofs_neigh =
+            neighbors[n].cell->get_fe().n_dofs_per_cell();
+          const unsigned int n_dofs_neigh2 =
+            neighbors[n_2].cell->get_fe().n_dofs_per_cell();
+
+          local_dof_indices_neighbor.resize(n_dofs_neigh);
+          local_dof_indices_neighbor_2.resize(n_dofs_neigh2);
+          neighbors[n].cell->get_dof_indices(local_dof_indices_neighbor);
+          neighbors[n_2].cell->get_dof_indices(local_dof_indices_neighbor_2);
+
+          stiffness_matrix_n1n2.reinit(n_dofs_neigh, n_dofs_neigh2);
+          stiffness_matrix_n2n1.reinit(n_dofs_neigh2, n_dofs_neigh);
+
+          for (unsigned int q = 0; q < n_q_points; ++q)
+            {
+              const double dx = fe_values.JxW(q);
+
+              for (unsigned int i = 0; i < n_dofs_neigh; ++i)
+                for (unsigned int j = 0; j < n_dofs_neigh2; ++j)
                   {
-                    fe_face_neighbor.reinit(neighbor_cell, face_no_neighbor);
-                    neighbor_cell->get_dof_indices(local_dof_indices_neighbor);
-
-                    ip_matrix_cn = 0;
-                    ip_matrix_nc = 0;
-                    ip_matrix_nn = 0;
-
-                    for (unsigned int q = 0; q < n_q_points_face; ++q)
-                      {
-                        const double dx = fe_face.JxW(q);
-
-                        for (unsigned int i = 0; i < n_dofs; ++i)
-                          {
-                            for (unsigned int j = 0; j < n_dofs; ++j)
-                              {
-                                ip_matrix_cc(i, j) +=
-                                  penalty_jump_grad * mesh_inv *
-                                  fe_face.shape_grad(j, q) *
-                                  fe_face.shape_grad(i, q) * dx;
-                                ip_matrix_cc(i, j) +=
-                                  penalty_jump_val * mesh3_inv *
-                                  fe_face.shape_value(j, q) *
-                                  fe_face.shape_value(i, q) * dx;
-
-                                ip_matrix_cn(i, j) -=
-                                  penalty_jump_grad * mesh_inv *
-                                  fe_face_neighbor.shape_grad(j, q) *
-                                  fe_face.shape_grad(i, q) * dx;
-                                ip_matrix_cn(i, j) -=
-                                  penalty_jump_val * mesh3_inv *
-                                  fe_face_neighbor.shape_value(j, q) *
-                                  fe_face.shape_value(i, q) * dx;
-
-                                ip_matrix_nc(i, j) -=
-                                  penalty_jump_grad * mesh_inv *
-                                  fe_face.shape_grad(j, q) *
-                                  fe_face_neighbor.shape_grad(i, q) * dx;
-                                ip_matrix_nc(i, j) -=
-                                  penalty_jump_val * mesh3_inv *
-                                  fe_face.shape_value(j, q) *
-                                  fe_face_neighbor.shape_value(i, q) * dx;
-
-                                ip_matrix_nn(i, j) +=
-                                  penalty_jump_grad * mesh_inv *
-                                  fe_face_neighbor.shape_grad(j, q) *
-                                  fe_face_neighbor.shape_grad(i, q) * dx;
-                                ip_matrix_nn(i, j) +=
-                                  penalty_jump_val * mesh3_inv *
-                                  fe_face_neighbor.shape_value(j, q) *
-                                  fe_face_neighbor.shape_value(i, q) * dx;
-                              }
-                          }
-                      }
-                  } // face not visited yet
-
-              } // boundary check
+                    const Tensor<2, dim> &H_i_neigh =
+                      discrete_hessians_neigh[n][i][q];
+                    const Tensor<2, dim> &H_j_neigh2 =
+                      discrete_hessians_neigh[n_2][j][q];
+
+                    stiffness_matrix_n1n2(i, j) +=
+                      scalar_product(H_j_neigh2, H_i_neigh) * dx;
+                    stiffness_matrix_n2n1(j, i) +=
+                      scalar_product(H_i_neigh, H_j_neigh2) * dx;
+                  }
+            }
+
+          copy_data.add(local_dof_indices_neighbor,
+                        local_dof_indices_neighbor_2,
+                        stiffness_matrix_n1n2);
+          copy_data.add(local_dof_indices_neighbor_2,
+                        local_dof_indices_neighbor,
+                        stiffness_matrix_n2n1);
+        } // for pairs of neighbors
+
+
+    for (unsigned int face_no = 0; face_no < cell->n_faces(); ++face_no)
+      {
+        const typename DoFHandler<dim>::face_iterator face =
+          cell->face(face_no);
+
+        const bool at_boundary = face->at_boundary();
+
+        // The penalty terms of an interior face are computed from the finer
+        // side if the neighbors differ in level: the mesh size is then the
+        // diameter of the smaller face, and the points of the face of the
+        // finer cell match those of a subface of the coarser one.
+        if (!at_boundary && face->has_children())
+          continue; // computed by the finer neighbors
+
+        const double mesh_inv = 1.0 / face->diameter(); // h_e^{-1}
+        const double mesh3_inv =
+          1.0 / std::pow(face->diameter(), 3); // ĥ_e^{-3}
+
+        // filled in any case (boundary or interior face)
+        ip_matrix_cc.reinit(n_dofs, n_dofs);
+
+        if (at_boundary)
+          {
+            scratch_data.fe_face.reinit(cell, face_no);
+            const FEFaceValues<dim> &fe_face =
+              scratch_data.fe_face.get_present_fe_values();
+
+            for (unsigned int q = 0; q < fe_face.n_quadrature_points; ++q)
+              {
+                const double dx = fe_face.JxW(q);
+
+                for (unsigned int i = 0; i < n_dofs; ++i)
+                  for (unsigned int j = 0; j < n_dofs; ++j)
+                    {
+                      ip_matrix_cc(i, j) += penalty_jump_grad * mesh_inv *
+                                            fe_face.shape_grad(j, q) *
+                                            fe_face.shape_grad(i, q) * dx;
+                      ip_matrix_cc(i, j) += penalty_jump_val * mesh3_inv *
+                                            fe_face.shape_value(j, q) *
+                                            fe_face.shape_value(i, q) * dx;
+                    }
+              }
+          }
+        else
+          { // interior face
+
+            const typename DoFHandler<dim>::active_cell_iterator
+              neighbor_cell = cell->neighbor(face_no);
+
+            if (!cell->neighbor_is_coarser(face_no) &&
+                neighbor_cell->id() < cell->id())
+              continue; // skip this face (already considered)
+            else
+              {
+                // Both sides are evaluated with the quadrature rule of the
+                // higher of the two degrees.
+                const unsigned int q_index =
+                  face_quadrature_index<dim>(cell, neighbor_cell);
+
+                scratch_data.fe_face.reinit(cell, face_no, q_index);
+                const FEFaceValues<dim> &fe_face =
+                  scratch_data.fe_face.get_present_fe_values();
+
+                const FEFaceValuesBase<dim> &fe_face_neigh =
+                  (cell->neighbor_is_coarser(face_no) ?
+                     reinit_face_values(
+                       neighbor_cell,
+                       cell->neighbor_of_coarser_neighbor(face_no).first,
+                       cell->neighbor_of_coarser_neighbor(face_no).second,
+                       q_index,
+                       numbers::invalid_unsigned_int,
+                       fe_face_neighbor,
+                       fe_subface_neighbor) :
+                     reinit_face_values(neighbor_cell,
+                                        cell->neighbor_of_neighbor(face_no),
+                                        numbers::invalid_unsigned_int,
+                                        q_index,
+                                        numbers::invalid_unsigned_int,
+                                        fe_face_neighbor,
+                                        fe_subface_neighbor));
+
+                const unsigned int n_dofs_neigh = fe_face_neigh.dofs_per_cell;
+
+                local_dof_indices_neighbor.resize(n_dofs_neigh);
+                neighbor_cell->get_dof_indices(local_dof_indices_neighbor);
+
+                ip_matrix_cn.reinit(n_dofs, n_dofs_neigh);
+                ip_matrix_nc.reinit(n_dofs_neigh, n_dofs);
+                ip_matrix_nn.reinit(n_dofs_neigh, n_dofs_neigh);
+
+                for (unsigned int q = 0; q < fe_face.n_quadrature_points; ++q)
+                  {
+                    const double dx = fe_face.JxW(q);
+
+                    for (unsigned int i = 0; i < n_dofs; ++i)
+                      for (unsigned int j = 0; j < n_dofs; ++j)
+                        {
+                          ip_matrix_cc(i, j) +=
+                            penalty_jump_grad * mesh_inv *
+                            fe_face.shape_grad(j, q) *
+                            fe_face.shape_grad(i, q) * dx;
+                          ip_matrix_cc(i, j) +=
+                            penalty_jump_val * mesh3_inv *
+                            fe_face.shape_value(j, q) *
+                            fe_face.shape_value(i, q) * dx;
+                        }
+
+                    for (unsigned int i = 0; i < n_dofs; ++i)
+                      for (unsigned int j = 0; j < n_dofs_neigh; ++j)
+                        {
+                          const double grad_term =
+                            penalty_jump_grad * mesh_inv *
+                            fe_face_neigh.shape_grad(j, q) *
+                            fe_face.shape_grad(i, q) * dx;
+                          const double value_term =
+                            penalty_jump_val * mesh3_inv *
+                            fe_face_neigh.shape_value(j, q) *
+                            fe_face.shape_value(i, q) * dx;
+
+                          ip_matrix_cn(i, j) -= grad_term + value_term;
+                          ip_matrix_nc(j, i) -= grad_term + value_term;
+                        }
+
+                    for (unsigned int i = 0; i < n_dofs_neigh; ++i)
+                      for (unsigned int j = 0; j < n_dofs_neigh; ++j)
+                        {
+                          ip_matrix_nn(i, j) +=
+                            penalty_jump_grad * mesh_inv *
+                            fe_face_neigh.shape_grad(j, q) *
+                            fe_face_neigh.shape_grad(i, q) * dx;
+                          ip_matrix_nn(i, j) +=
+                            penalty_jump_val * mesh3_inv *
+                            fe_face_neigh.shape_value(j, q) *
+                            fe_face_neigh.shape_value(i, q) * dx;
+                        }
+                  }
+              } // face not visited yet
+
+          } // boundary check
+
+        copy_data.add(local_dof_indices, local_dof_indices, ip_matrix_cc);
+
+        if (!at_boundary)
+          {
+            copy_data.add(local_dof_indices,
+                          local_dof_indices_neighbor,
+                          ip_matrix_cn);
+            copy_data.add(local_dof_indices_neighbor,
+                          local_dof_indices,
+                          ip_matrix_nc);
+            copy_data.add(local_dof_indices_neighbor,
+                          local_dof_indices_neighbor,
+                          ip_matrix_nn);
+          }
+
+      } // for face
+
+    if (parameters.incremental_assembly)
+      discard_reused_rows(cell, neighbors, copy_data, first_block);
+  }
+
+
+
+  // The contributions of a cell only depend on the cell and its face
+  // neighbors: the liftings of the shape functions of both live on the
+  // cell, and the penalty terms on its faces. The rows of a cell get the
+  // contributions of the cell and of its neighbors, and are thus the same
+  // as on the previous mesh if the cell and each of its neighbors still
+  // has the neighbors and the degrees it had then, i.e. if no cell up to
+  // two faces away changed. Only the rows of locally owned cells whose
+  // neighbors are locally owned were kept, see store_cell_matrix_rows().
+  template <int dim, typename LinearAlgebra>
+  void BiLaplacianLDGLift<dim, LinearAlgebra>::find_reused_matrix_rows()
+  {
+    reused_matrix_rows.assign(triangulation.n_active_cells(), false);
+
+    std::vector<bool> unchanged(triangulation.n_active_cells(), false);
+
+    std::vector<FaceNeighbor<dim>> neighbors;
+
+    for (const auto &cell : dof_handler.active_cell_iterators())
+      if (cell->is_locally_owned())
+        {
+          const auto entry = previous_cell_matrix_rows.find(cell->id());
+          if (entry == previous_cell_matrix_rows.end())
+            continue;
+
+          const std::vector<std::pair<CellId, unsigned int>> &cells =
+            entry->second.cells;
+          get_face_neighbors(cell, neighbors);
+          bool same = (cells.size() == neighbors.size() + 1 &&
+                       cells[0] == std::make_pair(cell->id(),
+                                                  cell->active_fe_index()));
+          for (unsigned int n = 0; same && n < neighbors.size(); ++n)
+            same = (cells[n + 1] ==
+                    std::make_pair(neighbors[n].cell->id(),
+                                   neighbors[n].cell->active_fe_index()));
+          unchanged[cell->active_cell_index()] = same;
+        }
+
+    for (const auto &cell : dof_handler.active_cell_iterators())
+      if (cell->is_locally_owned() && unchanged[cell->active_cell_index()] &&
+          !previous_cell_matrix_rows.find(cell->id())->second.blocks.empty())
+        {
+          get_face_neighbors(cell, neighbors);
+          bool reused = true;
+          for (const auto &neighbor : neighbors)
+            if (!neighbor.cell->is_locally_owned() ||
+                !unchanged[neighbor.cell->active_cell_index()])
+              reused = false;
+          reused_matrix_rows[cell->active_cell_index()] = reused;
+        }
+  }
+
+
+
+  // Add the rows of a cell kept from the previous mesh, if they are copied,
+  // with the current DoF indices of the cells up to two faces away. The
+  // contributions of a cell only go to its own rows and to those of its
+  // neighbors, so the cell is only computed again if one of these rows is
+  // not copied. Different threads read different entries of the map.
+  template <int dim, typename LinearAlgebra>
+  bool BiLaplacianLDGLift<dim, LinearAlgebra>::reuse_cell_matrix(
+    const typename DoFHandler<dim>::active_cell_iterator &cell,
+    const std::vector<FaceNeighbor<dim>> &                neighbors,
+    Assembly::CopyData::Matrix &                          copy_data)
+  {
+    if (!reused_matrix_rows[cell->active_cell_index()])
+      return false;
+
+    const CellMatrixRows &rows =
+      previous_cell_matrix_rows.find(cell->id())->second;
+
+    std::vector<typename DoFHandler<dim>::active_cell_iterator> two_ring;
+    get_two_ring(cell, neighbors, two_ring);
+    AssertDimension(two_ring.size(), rows.blocks.size());
+
+    std::vector<types::global_dof_index> dof_indices(
+      cell->get_fe().n_dofs_per_cell());
+    std::vector<types::global_dof_index> column_dof_indices;
+    cell->get_dof_indices(dof_indices);
+    for (unsigned int c = 0; c < two_ring.size(); ++c)
+      {
+        column_dof_indices.resize(two_ring[c]->get_fe().n_dofs_per_cell());
+        two_ring[c]->get_dof_indices(column_dof_indices);
+        copy_data.add(dof_indices, column_dof_indices, rows.blocks[c]);
+      }
+    ++n_reused_cells;
+
+    for (const auto &neighbor : neighbors)
+      if (!reused_matrix_rows[neighbor.cell->active_cell_index()])
+        return false;
+    return true;
+  }
+
+
+
+  // Remove the blocks a cell computed again has just added to copy_data,
+  // starting at first_block, in the rows that are copied instead. Since
+  // every cell has its own DoFs, the first row of a block tells which of
+  // the cell and its neighbors it belongs to.
+  template <int dim, typename LinearAlgebra>
+  void BiLaplacianLDGLift<dim, LinearAlgebra>::discard_reused_rows(
+    const typename DoFHandler<dim>::active_cell_iterator &cell,
+    const std::vector<FaceNeighbor<dim>> &                neighbors,
+    Assembly::CopyData::Matrix &                          copy_data,
+    const unsigned int                                    first_block) const
+  {
+    const auto is_reused = [&](const types::global_dof_index first_row) {
+      if (first_row == cell->dof_index(0))
+        return reused_matrix_rows[cell->active_cell_index()];
+      for (const auto &neighbor : neighbors)
+        if (first_row == neighbor.cell->dof_index(0))
+          return reused_matrix_rows[neighbor.cell->active_cell_index()];
+      return false;
+    };
+
+    unsigned int n_blocks = first_block;
+    for (unsigned int b = first_block; b < copy_data.n_blocks; ++b)
+      if (!is_reused(copy_data.blocks[b].row_dof_indices[0]))
+        {
+          if (b != n_blocks)
+            std::swap(copy_data.blocks[n_blocks], copy_data.blocks[b]);
+          ++n_blocks;
+        }
+    copy_data.n_blocks = n_blocks;
+  }
+
+
+
+  template <int dim, typename LinearAlgebra>
+  void BiLaplacianLDGLift<dim, LinearAlgebra>::copy_local_to_global_matrix(
+    const Assembly::CopyData::Matrix &copy_data)
+  {
+    if (off_process_exchange.in_progress)
+      progress_off_process_exchange();
+
+    for (unsigned int b = 0; b < copy_data.n_blocks; ++b)
+      {
+        const auto &block = copy_data.blocks[b];
+
+        // The rows of a block are the DoFs of one cell, so they are all
+        // owned by the same process.
+        if (!(parameters.deterministic ||
+              parameters.overlap_communication) ||
+            locally_owned_dofs.is_element(block.row_dof_indices[0]))
+          {
+            matrix.add(block.row_dof_indices,
+                       block.column_dof_indices,
+                       block.matrix);
+            continue;
+          }
+
+        unsigned int owner = 0;
+        while (!locally_owned_dofs_per_process[owner].is_element(
+          block.row_dof_indices[0]))
+          ++owner;
+
+        auto &entries = off_process_entries[owner];
+        for (unsigned int i = 0; i < block.row_dof_indices.size(); ++i)
+          for (unsigned int j = 0; j < block.column_dof_indices.size(); ++j)
+            {
+              entries.first.push_back(block.row_dof_indices[i]);
+              entries.first.push_back(block.column_dof_indices[j]);
+              entries.second.push_back(block.matrix(i, j));
+            }
+      }
+  }
+
+
+
+  template <int dim, typename LinearAlgebra>
+  void BiLaplacianLDGLift<dim, LinearAlgebra>::assemble_rhs()
+  {
+    rhs = 0;
+
+    const hp::QCollection<dim> &quad = reference_data->quad;
+
+    Assembly::CopyData::RHS copy_data;
+    copy_data.local_rhs.reinit(fe.max_dofs_per_cell());
+    copy_data.local_dof_indices.resize(fe.max_dofs_per_cell());
+
+    WorkStream::run(
+      CellFilter(IteratorFilters::LocallyOwnedCell(),
+                 dof_handler.begin_active()),
+      CellFilter(IteratorFilters::LocallyOwnedCell(), dof_handler.end()),
+      [this](const typename DoFHandler<dim>::active_cell_iterator &cell,
+             Assembly::Scratch::RHS<dim> &                         scratch_data,
+             Assembly::CopyData::RHS &                             copy_data) {
+        local_assemble_rhs(cell, scratch_data, copy_data);
+      },
+      [this](const Assembly::CopyData::RHS &copy_data) {
+        copy_local_to_global_rhs(copy_data);
+      },
+      Assembly::Scratch::RHS<dim>(mapping_collection, fe, quad),
+      copy_data);
+
+    rhs.compress(VectorOperation::add);
+  }
+
+
+
+  template <int dim, typename LinearAlgebra>
+  void BiLaplacianLDGLift<dim, LinearAlgebra>::local_assemble_rhs(
+    const typename DoFHandler<dim>::active_cell_iterator &cell,
+    Assembly::Scratch::RHS<dim> &                         scratch_data,
+    Assembly::CopyData::RHS &                             copy_data)
+  {
+    scratch_data.fe_values.reinit(cell);
+    const FEValues<dim> &fe_values =
+      scratch_data.fe_values.get_present_fe_values();
+
+    const unsigned int n_dofs     = fe_values.dofs_per_cell;
+    const unsigned int n_quad_pts = fe_values.n_quadrature_points;
+
+    const RightHandSide<dim> right_hand_side;
+
+    Vector<double> &local_rhs = copy_data.local_rhs;
+
+    local_rhs.reinit(n_dofs);
+    copy_data.local_dof_indices.resize(n_dofs);
+    cell->get_dof_indices(copy_data.local_dof_indices);
+
+    // The right hand side of a cell only depends on the cell, so it is
+    // copied from the previous mesh if the cell and its degree are the same.
+    if (parameters.incremental_assembly)
+      {
+        const auto entry = previous_cell_rhs.find(cell->id());
+        if (entry != previous_cell_rhs.end() &&
+            entry->second.first == cell->active_fe_index())
+          {
+            local_rhs = entry->second.second;
+            ++n_reused_rhs_cells;
+            return;
+          }
+      }
+
+    std::vector<double> &rhs_values = scratch_data.rhs_values;
+    rhs_values.resize(n_quad_pts);
+    right_hand_side.value_list(fe_values.get_quadrature_points(), rhs_values);
+
+    local_rhs = 0;
+    for (unsigned int q = 0; q < n_quad_pts; ++q)
+      {
+        const double f_dx = rhs_values[q] * fe_values.JxW(q);
 
-            for (unsigned int i = 0; i < n_dofs; ++i)
+        for (unsigned int i = 0; i < n_dofs; ++i)
+          local_rhs(i) += f_dx * fe_values.shape_value(i, q);
+      }
+  }
+
+
+
+  template <int dim, typename LinearAlgebra>
+  void BiLaplacianLDGLift<dim, LinearAlgebra>::copy_local_to_global_rhs(
+    const Assembly::CopyData::RHS &copy_data)
+  {
+    rhs.add(copy_data.local_dof_indices, copy_data.local_rhs);
+  }
+
+
+
+  template <int dim, typename LinearAlgebra>
+  void BiLaplacianLDGLift<dim, LinearAlgebra>::solve()
+  {
+    const unsigned int n_iterations = LinearAlgebra::solve(
+      parameters, matrix, solution, rhs, mpi_communicator);
+
+    if (parameters.solver != "direct")
+      pcout << "Number of CG iterations: " << n_iterations << std::endl;
+
+    // Copy the locally owned values of the solution. The values on the
+    // ghost cells, which the error computation and the output need as
+    // well, are only updated in compute_errors().
+    const std::vector<types::global_dof_index> indices =
+      locally_owned_dofs.get_index_vector();
+    std::vector<double> values(indices.size());
+    solution.extract_subvector_to(indices, values);
+
+    locally_relevant_solution.zero_out_ghost_values();
+    for (unsigned int i = 0; i < values.size(); ++i)
+      locally_relevant_solution.local_element(i) = values[i];
+  }
+
+
+
+  // Time products of the matrix with a vector, which dominate the iterative
+  // solvers and read every nonzero entry once, after one product that
+  // brings the data into the caches. The time of the slowest process is
+  // reported, together with the number of nonzero entries processed per
+  // second, to compare the orderings of the degrees of freedom.
+  template <int dim, typename LinearAlgebra>
+  void
+  BiLaplacianLDGLift<dim, LinearAlgebra>::benchmark_matrix_vector_product()
+  {
+    typename LinearAlgebra::Vector src, dst;
+    LinearAlgebra::reinit_vector(src,
+                                 locally_owned_dofs,
+                                 IndexSet(),
+                                 mpi_communicator);
+    LinearAlgebra::reinit_vector(dst,
+                                 locally_owned_dofs,
+                                 IndexSet(),
+                                 mpi_communicator);
+    if (LinearAlgebra::threaded_first_touch)
+      {
+        first_touch(src);
+        first_touch(dst);
+      }
+    src = 1.0;
+
+    matrix.vmult(dst, src);
+
+    const auto start = std::chrono::steady_clock::now();
+    for (unsigned int i = 0; i < parameters.n_benchmark_products; ++i)
+      matrix.vmult(dst, src);
+    const double time = Utilities::MPI::max(
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+          .count() /
+        parameters.n_benchmark_products,
+      mpi_communicator);
+
+    pcout << "Matrix-vector product: " << 1000. * time << " ms, "
+          << matrix.n_nonzero_elements() / time / 1e9
+          << " billion nonzero entries per second" << std::endl;
+  }
+
+
+
+  // The errors in the DG H2, DG H1 and L2 norms, computed in one pass over
+  // the cells by the threads of every process. The contributions of the
+  // cells are added up in the copier, so that every norm only needs one
+  // reduction over the processes at the end.
+  template <int dim, typename LinearAlgebra>
+  ErrorNorms BiLaplacianLDGLift<dim, LinearAlgebra>::compute_errors()
+  {
+    double error_H2 = 0;
+    double error_H1 = 0;
+    double error_L2 = 0;
+
+    // The contributions of the locally owned cells, only collected in the
+    // deterministic mode.
+    std::vector<std::pair<CellId, std::array<double, 3>>> cell_errors;
+
+    const hp::QCollection<dim> &    quad      = reference_data->quad;
+    const hp::QCollection<dim - 1> &quad_face = reference_data->quad_face;
+
+    // When overlapping communication, the errors on the halo cells are
+    // computed last: the update of the values of the solution on the ghost
+    // cells is started first, and finished once the errors on all other
+    // cells are known.
+    const auto compute_errors_on_cells = [&](const bool halo) {
+      const auto predicate =
+        [this,
+         halo](const typename DoFHandler<dim>::active_cell_iterator &cell) {
+          return cell->is_locally_owned() &&
+                 (!parameters.overlap_communication ||
+                  is_halo_cell(cell) == halo);
+        };
+
+      WorkStream::run(
+        CellFilter(predicate, dof_handler.begin_active()),
+        CellFilter(predicate, dof_handler.end()),
+        [this](const typename DoFHandler<dim>::active_cell_iterator &cell,
+               Assembly::Scratch::Errors<dim> &scratch_data,
+               Assembly::CopyData::Errors &    copy_data) {
+          copy_data.cell_id = cell->id();
+          local_compute_errors(cell, scratch_data, copy_data);
+        },
+        [this, &error_H2, &error_H1, &error_L2, &cell_errors](
+          const Assembly::CopyData::Errors &copy_data) {
+          if (parameters.deterministic)
+            cell_errors.emplace_back(
+              copy_data.cell_id,
+              std::array<double, 3>{{copy_data.error_H2,
+                                     copy_data.error_H1,
+                                     copy_data.error_L2}});
+          else
+            {
+              error_H2 += copy_data.error_H2;
+              error_H1 += copy_data.error_H1;
+              error_L2 += copy_data.error_L2;
+            }
+        },
+        Assembly::Scratch::Errors<dim>(mapping_collection, fe, quad, quad_face),
+        Assembly::CopyData::Errors());
+    };
+
+    {
+      TimerOutput::Scope t(computing_timer, "Compute errors: communication");
+      locally_relevant_solution.update_ghost_values_start();
+      if (!parameters.overlap_communication)
+        locally_relevant_solution.update_ghost_values_finish();
+    }
+    compute_errors_on_cells(/*halo=*/false);
+
+    if (parameters.overlap_communication)
+      {
+        {
+          TimerOutput::Scope t(computing_timer,
+                               "Compute errors: communication");
+          locally_relevant_solution.update_ghost_values_finish();
+        }
+        compute_errors_on_cells(/*halo=*/true);
+      }
+
+    if (parameters.deterministic)
+      {
+        // Every process adds up the contributions of its cells in the order
+        // of their ids and with a fixed summation tree, and the first
+        // process adds up the partial sums of the processes in the order of
+        // their ranks, again with a fixed tree, and sends the sums back.
+        // Only three values per process are communicated, and the sorting
+        // and summation are spread over the processes. The result does not
+        // depend on the number of threads or on the order in which the
+        // threads finish, but like the matrix, it depends on the partition
+        // of the cells, and thus on the number of processes. The time of
+        // this reduction is printed, to compare it with the computation of
+        // the errors itself.
+        Timer reduction_timer;
+
+        std::sort(cell_errors.begin(),
+                  cell_errors.end(),
+                  [](const std::pair<CellId, std::array<double, 3>> &a,
+                     const std::pair<CellId, std::array<double, 3>> &b) {
+                    return a.first < b.first;
+                  });
+
+        std::vector<double> partial_sums(3);
+        for (unsigned int k = 0; k < partial_sums.size(); ++k)
+          {
+            std::vector<double> values;
+            values.reserve(cell_errors.size());
+            for (const auto &errors : cell_errors)
+              values.push_back(errors.second[k]);
+            partial_sums[k] = pairwise_sum(values);
+          }
+
+        const std::vector<std::vector<double>> all_partial_sums =
+          Utilities::MPI::gather(mpi_communicator, partial_sums, 0);
+
+        std::vector<double> sums(3, 0.);
+        if (Utilities::MPI::this_mpi_process(mpi_communicator) == 0)
+          for (unsigned int k = 0; k < sums.size(); ++k)
+            {
+              std::vector<double> values;
+              for (const auto &process_sums : all_partial_sums)
+                values.push_back(process_sums[k]);
+              sums[k] = pairwise_sum(values);
+            }
+        sums = Utilities::MPI::broadcast(mpi_communicator, sums, 0);
+
+        reduction_timer.stop();
+        pcout << "Deterministic reduction of the errors: "
+              << Utilities::MPI::max(reduction_timer.wall_time(),
+                                     mpi_communicator)
+              << " s" << std::endl;
+
+        error_H2 = std::sqrt(sums[0]);
+        error_H1 = std::sqrt(sums[1]);
+        error_L2 = std::sqrt(sums[2]);
+      }
+    else
+      {
+        error_H2 = std::sqrt(Utilities::MPI::sum(error_H2, mpi_communicator));
+        error_H1 = std::sqrt(Utilities::MPI::sum(error_H1, mpi_communicator));
+        error_L2 = std::sqrt(Utilities::MPI::sum(error_L2, mpi_communicator));
+      }
+
+    ErrorNorms norms;
+    norms.H2 = error_H2;
+    norms.H1 = error_H1;
+    norms.L2 = error_L2;
+    return norms;
+  }
+
+
+
+  template <int dim, typename LinearAlgebra>
+  void BiLaplacianLDGLift<dim, LinearAlgebra>::local_compute_errors(
+    const typename DoFHandler<dim>::active_cell_iterator &cell,
+    Assembly::Scratch::Errors<dim> &                      scratch_data,
+    Assembly::CopyData::Errors &                          copy_data)
+  {
+    hp::FEFaceValues<dim> &   fe_face_neighbor = scratch_data.fe_face_neighbor;
+    hp::FESubfaceValues<dim> &fe_subface_neighbor =
+      scratch_data.fe_subface_neighbor;
+
+    scratch_data.fe_values.reinit(cell);
+    const FEValues<dim> &fe_values =
+      scratch_data.fe_values.get_present_fe_values();
+
+    const unsigned int n_q_points = fe_values.n_quadrature_points;
+
+    const ExactSolution<dim> u_exact;
+
+    std::vector<double> &solution_values_cell =
+      scratch_data.solution_values_cell;
+    std::vector<Tensor<1, dim>> &solution_gradients_cell =
+      scratch_data.solution_gradients_cell;
+    std::vector<Tensor<2, dim>> &solution_hessians_cell =
+      scratch_data.solution_hessians_cell;
+
+    std::vector<double> &solution_values = scratch_data.solution_values;
+    std::vector<double> &solution_values_neigh =
+      scratch_data.solution_values_neigh;
+    std::vector<Tensor<1, dim>> &solution_gradients =
+      scratch_data.solution_gradients;
+    std::vector<Tensor<1, dim>> &solution_gradients_neigh =
+      scratch_data.solution_gradients_neigh;
+
+    std::vector<double> &        exact_values    = scratch_data.exact_values;
+    std::vector<Tensor<1, dim>> &exact_gradients = scratch_data.exact_gradients;
+    std::vector<SymmetricTensor<2, dim>> &exact_hessians =
+      scratch_data.exact_hessians;
+
+    copy_data.error_H2 = 0;
+    copy_data.error_H1 = 0;
+    copy_data.error_L2 = 0;
+
+    solution_values_cell.resize(n_q_points);
+    solution_gradients_cell.resize(n_q_points);
+    solution_hessians_cell.resize(n_q_points);
+
+    fe_values.get_function_values(locally_relevant_solution,
+                                  solution_values_cell);
+    fe_values.get_function_gradients(locally_relevant_solution,
+                                     solution_gradients_cell);
+    fe_values.get_function_hessians(locally_relevant_solution,
+                                    solution_hessians_cell);
+
+    exact_values.resize(n_q_points);
+    exact_gradients.resize(n_q_points);
+    exact_hessians.resize(n_q_points);
+    u_exact.value_gradient_hessian_list(fe_values.get_quadrature_points(),
+                                        exact_values,
+                                        exact_gradients,
+                                        exact_hessians);
+
+    for (unsigned int q = 0; q < n_q_points; ++q)
+      {
+        const double dx = fe_values.JxW(q);
+
+        copy_data.error_H2 +=
+          (exact_hessians[q] - solution_hessians_cell[q]).norm_square() * dx;
+        copy_data.error_H1 +=
+          (exact_gradients[q] - solution_gradients_cell[q]).norm_square() * dx;
+        copy_data.error_L2 +=
+          std::pow(exact_values[q] - solution_values_cell[q], 2) * dx;
+      } // for quadrature points
+
+    for (unsigned int face_no = 0; face_no < cell->n_faces(); ++face_no)
+      {
+        const typename DoFHandler<dim>::face_iterator face =
+          cell->face(face_no);
+
+        // As in the assembly, faces between cells of different levels are
+        // considered from the finer side.
+        if (!face->at_boundary() && face->has_children())
+          continue;
+
+        const bool at_boundary = face->at_boundary();
+
+        if (!at_boundary && !cell->neighbor_is_coarser(face_no) &&
+            cell->neighbor(face_no)->id() < cell->id())
+          continue; // skip this face (already considered)
+
+        const double mesh_inv = 1.0 / face->diameter(); // h^{-1}
+        const double mesh3_inv =
+          1.0 / std::pow(face->diameter(), 3); // h^{-3}
+
+        // On an interior face, both sides are evaluated with the quadrature
+        // rule of the higher of the two degrees. The traces of the solution
+        // on the cell are computed once and used for the boundary terms as
+        // well as for the jumps.
+        scratch_data.fe_face.reinit(
+          cell,
+          face_no,
+          (at_boundary ? cell->active_fe_index() :
+                         face_quadrature_index<dim>(cell,
+                                                    cell->neighbor(face_no))));
+        const FEFaceValues<dim> &fe_face =
+          scratch_data.fe_face.get_present_fe_values();
+
+        const unsigned int n_q_points_face = fe_face.n_quadrature_points;
+
+        solution_values.resize(n_q_points_face);
+        solution_values_neigh.resize(n_q_points_face);
+        solution_gradients.resize(n_q_points_face);
+        solution_gradients_neigh.resize(n_q_points_face);
+
+        fe_face.get_function_values(locally_relevant_solution,
+                                    solution_values);
+        fe_face.get_function_gradients(locally_relevant_solution,
+                                       solution_gradients);
+
+        if (at_boundary)
+          {
+            exact_values.resize(n_q_points_face);
+            exact_gradients.resize(n_q_points_face);
+            exact_hessians.resize(n_q_points_face);
+            u_exact.value_gradient_hessian_list(
+              fe_face.get_quadrature_points(),
+              exact_values,
+              exact_gradients,
+              exact_hessians);
+
+            for (unsigned int q = 0; q < n_q_points_face; ++q)
+              {
+                const double dx = fe_face.JxW(q);
+
+                copy_data.error_H2 +=
+                  mesh_inv *
+                  (exact_gradients[q] - solution_gradients[q]).norm_square() *
+                  dx;
+                copy_data.error_H2 +=
+                  mesh3_inv *
+                  std::pow(exact_values[q] - solution_values[q], 2) * dx;
+                copy_data.error_H1 +=
+                  mesh_inv *
+                  std::pow(exact_values[q] - solution_values[q], 2) * dx;
+              }
+          }
+        else
+          { // interior face
+
+            const typename DoFHandler<dim>::active_cell_iterator
+              neighbor_cell = cell->neighbor(face_no);
+
+            const unsigned int q_index =
+              face_quadrature_index<dim>(cell, neighbor_cell);
+
+            const FEFaceValuesBase<dim> &fe_face_neigh =
+              (cell->neighbor_is_coarser(face_no) ?
+                 reinit_face_values(
+                   neighbor_cell,
+                   cell->neighbor_of_coarser_neighbor(face_no).first,
+                   cell->neighbor_of_coarser_neighbor(face_no).second,
+                   q_index,
+                   numbers::invalid_unsigned_int,
+                   fe_face_neighbor,
+                   fe_subface_neighbor) :
+                 reinit_face_values(neighbor_cell,
+                                    cell->neighbor_of_neighbor(face_no),
+                                    numbers::invalid_unsigned_int,
+                                    q_index,
+                                    numbers::invalid_unsigned_int,
+                                    fe_face_neighbor,
+                                    fe_subface_neighbor));
+
+            fe_face_neigh.get_function_values(locally_relevant_solution,
+                                              solution_values_neigh);
+            fe_face_neigh.get_function_gradients(locally_relevant_solution,
+                                                 solution_gradients_neigh);
+
+            for (unsigned int q = 0; q < n_q_points_face; ++q)
+              {
+                const double dx = fe_face.JxW(q);
+
+                copy_data.error_H2 +=
+                  mesh_inv *
+                  (solution_gradients_neigh[q] - solution_gradients[q])
+                    .norm_square() *
+                  dx;
+                copy_data.error_H2 +=
+                  mesh3_inv *
+                  std::pow(solution_values_neigh[q] - solution_values[q], 2) *
+                  dx;
+                copy_data.error_H1 +=
+                  mesh_inv *
+                  std::pow(solution_values_neigh[q] - solution_values[q], 2) *
+                  dx;
+              }
+          } // boundary check
+
+      } // for face
+  }
+
+
+
+  // A residual-type indicator of the error in the DG H2 norm, see
+  // E.H. Georgoulis, P. Houston and J. Virtanen, "An a posteriori error
+  // indicator for discontinuous Galerkin approximations of fourth-order
+  // elliptic problems", IMA J. Numer. Anal. 31 (2011). The indicator of a
+  // cell K is the square root of
+  //   h_K^4 ||f - Δ²u_h||_K^2
+  //   + 1/2 Σ_e (h_e^3 ||[∇Δu_h·n]||_e^2 + h_e ||[D²u_h n]||_e^2)
+  //   + Σ_e (h_e^{-1} ||[∇u_h]||_e^2 + h_e^{-3} ||[u_h]||_e^2),
+  // where the first sum runs over the interior faces of K and the second
+  // over all faces of K, with the factor 1/2 on interior faces; on the
+  // boundary, the jumps are the values of u_h and of its gradient. The last
+  // two terms are the face terms of the DG H2 norm of compute_errors(). On
+  // a refined face, the terms are computed on every child. The indicators
+  // use the values of the solution on the ghost cells, which are up to date
+  // once compute_errors() is done.
+  template <int dim, typename LinearAlgebra>
+  void BiLaplacianLDGLift<dim, LinearAlgebra>::estimate_error()
+  {
+    const hp::QCollection<dim> &    quad      = reference_data->quad;
+    const hp::QCollection<dim - 1> &quad_face = reference_data->quad_face;
+
+    estimated_error_per_cell = 0;
+
+    WorkStream::run(
+      CellFilter(IteratorFilters::LocallyOwnedCell(),
+                 dof_handler.begin_active()),
+      CellFilter(IteratorFilters::LocallyOwnedCell(), dof_handler.end()),
+      [this](const typename DoFHandler<dim>::active_cell_iterator &cell,
+             Assembly::Scratch::Estimator<dim> &scratch_data,
+             Assembly::CopyData::Estimator &    copy_data) {
+        local_estimate_error(cell, scratch_data, copy_data);
+      },
+      [this](const Assembly::CopyData::Estimator &copy_data) {
+        estimated_error_per_cell(copy_data.active_cell_index) =
+          std::sqrt(copy_data.indicator);
+      },
+      Assembly::Scratch::Estimator<dim>(
+        mapping_collection, fe, quad, quad_face),
+      Assembly::CopyData::Estimator());
+
+    const double estimated_error = std::sqrt(Utilities::MPI::sum(
+      static_cast<double>(estimated_error_per_cell.norm_sqr()),
+      mpi_communicator));
+
+    pcout << "Estimated error: " << estimated_error << std::endl;
+  }
+
+
+
+  template <int dim, typename LinearAlgebra>
+  void BiLaplacianLDGLift<dim, LinearAlgebra>::local_estimate_error(
+    const typename DoFHandler<dim>::active_cell_iterator &cell,
+    Assembly::Scratch::Estimator<dim> &                   scratch_data,
+    Assembly::CopyData::Estimator &                       copy_data)
+  {
+    hp::FEFaceValues<dim> &   fe_face          = scratch_data.fe_face;
+    hp::FESubfaceValues<dim> &fe_subface       = scratch_data.fe_subface;
+    hp::FEFaceValues<dim> &   fe_face_neighbor = scratch_data.fe_face_neighbor;
+    hp::FESubfaceValues<dim> &fe_subface_neighbor =
+      scratch_data.fe_subface_neighbor;
+
+    scratch_data.fe_values.reinit(cell);
+    const FEValues<dim> &fe_values =
+      scratch_data.fe_values.get_present_fe_values();
+
+    const unsigned int n_q_points = fe_values.n_quadrature_points;
+
+    const unsigned int n_dofs = fe_values.dofs_per_cell;
+
+    const std::vector<std::vector<Tensor<4, dim>>> &shape_4th_derivatives =
+      reference_data->shape_4th_derivatives[cell->active_fe_index()];
+
+    const RightHandSide<dim> right_hand_side;
+
+    std::vector<FaceNeighbor<dim>> &neighbors = scratch_data.neighbors;
+    Vector<double> &local_dof_values = scratch_data.local_dof_values;
+
+    std::vector<double> &        values_here    = scratch_data.values_here;
+    std::vector<double> &        values_there   = scratch_data.values_there;
+    std::vector<Tensor<1, dim>> &gradients_here = scratch_data.gradients_here;
+    std::vector<Tensor<1, dim>> &gradients_there =
+      scratch_data.gradients_there;
+    std::vector<Tensor<2, dim>> &hessians_here  = scratch_data.hessians_here;
+    std::vector<Tensor<2, dim>> &hessians_there = scratch_data.hessians_there;
+    std::vector<Tensor<3, dim>> &third_derivatives_here =
+      scratch_data.third_derivatives_here;
+    std::vector<Tensor<3, dim>> &third_derivatives_there =
+      scratch_data.third_derivatives_there;
+
+    copy_data.active_cell_index = cell->active_cell_index();
+    copy_data.indicator         = 0;
+
+    local_dof_values.reinit(n_dofs);
+    cell->get_dof_values(locally_relevant_solution, local_dof_values);
+
+    // The fourth derivatives of the solution are those on the reference
+    // cell transformed by the inverse Jacobian of the mapping. This is exact
+    // on parallelograms and neglects the derivatives of the Jacobian on
+    // curved cells, whose contribution to the bilaplacian is of higher order
+    // in the mesh size and only changes the indicator, not the solution.
+    const double mesh4 = std::pow(cell->diameter(), 4); // h_K^4
+
+    std::vector<double> &rhs_values = scratch_data.rhs_values;
+    rhs_values.resize(n_q_points);
+    right_hand_side.value_list(fe_values.get_quadrature_points(), rhs_values);
+
+    for (unsigned int q = 0; q < n_q_points; ++q)
+      {
+        const double dx = fe_values.JxW(q);
+
+        Tensor<4, dim> reference_4th_derivative;
+        for (unsigned int i = 0; i < n_dofs; ++i)
+          reference_4th_derivative +=
+            local_dof_values(i) * shape_4th_derivatives[i][q];
+
+        // With J^{-1} the inverse Jacobian, the bilaplacian is the fourth
+        // derivative on the reference cell contracted twice with the metric
+        // J^{-1} J^{-T}.
+        const Tensor<2, dim> inverse_jacobian = fe_values.inverse_jacobian(q);
+        const Tensor<2, dim> metric =
+          inverse_jacobian * transpose(inverse_jacobian);
+
+        double bilaplacian = 0;
+        for (unsigned int r = 0; r < dim; ++r)
+          for (unsigned int s = 0; s < dim; ++s)
+            for (unsigned int t = 0; t < dim; ++t)
+              for (unsigned int u = 0; u < dim; ++u)
+                bilaplacian += reference_4th_derivative[r][s][t][u] *
+                               metric[r][s] * metric[t][u];
+
+        copy_data.indicator +=
+          mesh4 * std::pow(rhs_values[q] - bilaplacian, 2) * dx;
+      }
+
+    for (const unsigned int face_no : cell->face_indices())
+      if (cell->at_boundary(face_no))
+        {
+          const double mesh_inv = 1.0 / cell->face(face_no)->diameter();
+          const double mesh3_inv =
+            1.0 / std::pow(cell->face(face_no)->diameter(), 3);
+
+          fe_face.reinit(cell, face_no);
+          const FEFaceValues<dim> &fe_face_here =
+            fe_face.get_present_fe_values();
+
+          values_here.resize(fe_face_here.n_quadrature_points);
+          gradients_here.resize(fe_face_here.n_quadrature_points);
+          fe_face_here.get_function_values(locally_relevant_solution,
+                                           values_here);
+          fe_face_here.get_function_gradients(locally_relevant_solution,
+                                              gradients_here);
+
+          for (unsigned int q = 0; q < fe_face_here.n_quadrature_points; ++q)
+            {
+              const double dx = fe_face_here.JxW(q);
+
+              copy_data.indicator +=
+                (mesh_inv * gradients_here[q].norm_square() +
+                 mesh3_inv * std::pow(values_here[q], 2)) *
+                dx;
+            }
+        }
+
+    get_face_neighbors(cell, neighbors);
+    for (const auto &neighbor : neighbors)
+      {
+        const unsigned int q_index =
+          face_quadrature_index<dim>(cell, neighbor.cell);
+
+        const FEFaceValuesBase<dim> &fe_face_here =
+          reinit_face_values(cell,
+                             neighbor.face_no,
+                             neighbor.subface_no,
+                             q_index,
+                             numbers::invalid_unsigned_int,
+                             fe_face,
+                             fe_subface);
+        const FEFaceValuesBase<dim> &fe_face_there =
+          reinit_face_values(neighbor.cell,
+                             neighbor.neighbor_face_no,
+                             neighbor.neighbor_subface_no,
+                             q_index,
+                             numbers::invalid_unsigned_int,
+                             fe_face_neighbor,
+                             fe_subface_neighbor);
+
+        const unsigned int n_q_points_face = fe_face_here.n_quadrature_points;
+
+        values_here.resize(n_q_points_face);
+        values_there.resize(n_q_points_face);
+        gradients_here.resize(n_q_points_face);
+        gradients_there.resize(n_q_points_face);
+        hessians_here.resize(n_q_points_face);
+        hessians_there.resize(n_q_points_face);
+        third_derivatives_here.resize(n_q_points_face);
+        third_derivatives_there.resize(n_q_points_face);
+
+        const double face_diameter =
+          (neighbor.subface_no == numbers::invalid_unsigned_int ?
+             cell->face(neighbor.face_no)->diameter() :
+             cell->face(neighbor.face_no)
+               ->child(neighbor.subface_no)
+               ->diameter());
+        const double mesh      = face_diameter;                    // h_e
+        const double mesh3     = std::pow(face_diameter, 3);       // h_e^3
+        const double mesh_inv  = 1.0 / face_diameter;              // h_e^{-1}
+        const double mesh3_inv = 1.0 / std::pow(face_diameter, 3); // h_e^{-3}
+
+        fe_face_here.get_function_values(locally_relevant_solution,
+                                         values_here);
+        fe_face_there.get_function_values(locally_relevant_solution,
+                                          values_there);
+        fe_face_here.get_function_gradients(locally_relevant_solution,
+                                            gradients_here);
+        fe_face_there.get_function_gradients(locally_relevant_solution,
+                                             gradients_there);
+        fe_face_here.get_function_hessians(locally_relevant_solution,
+                                           hessians_here);
+        fe_face_there.get_function_hessians(locally_relevant_solution,
+                                            hessians_there);
+        fe_face_here.get_function_third_derivatives(locally_relevant_solution,
+                                                    third_derivatives_here);
+        fe_face_there.get_function_third_derivatives(
+          locally_relevant_solution, third_derivatives_there);
+
+        for (unsigned int q = 0; q < n_q_points_face; ++q)
+          {
+            const double         dx     = fe_face_here.JxW(q);
+            const Tensor<1, dim> normal = fe_face_here.normal_vector(q);
+
+            // The jump of the gradient of the Laplacian, whose c-th
+            // component is the sum of the third derivatives d_a d_a d_c.
+            Tensor<1, dim> jump_grad_laplacian;
+            for (unsigned int a = 0; a < dim; ++a)
+              for (unsigned int c = 0; c < dim; ++c)
+                jump_grad_laplacian[c] += third_derivatives_here[q][a][a][c] -
+                                          third_derivatives_there[q][a][a][c];
+
+            copy_data.indicator +=
+              0.5 *
+              (mesh3 * std::pow(jump_grad_laplacian * normal, 2) +
+               mesh * ((hessians_here[q] - hessians_there[q]) * normal)
+                        .norm_square()) *
+              dx;
+            copy_data.indicator +=
+              0.5 *
+              (mesh_inv *
+                 (gradients_here[q] - gradients_there[q]).norm_square() +
+               mesh3_inv * std::pow(values_here[q] - values_there[q], 2)) *
+              dx;
+          }
+      } // for neighbor
+  }
+
+
+
+  template <int dim, typename LinearAlgebra>
+  void BiLaplacianLDGLift<dim, LinearAlgebra>::output_results(
+    const unsigned int cycle) const
+  {
+    typename DataOutSnapshot<dim>::Source data_out;
+    data_out.attach_dof_handler(dof_handler);
+    data_out.add_data_vector(locally_relevant_solution, "solution");
+    if (parameters.refinement != "global")
+      data_out.add_data_vector(estimated_error_per_cell, "error_indicator");
+
+    Vector<float> fe_degrees(triangulation.n_active_cells());
+    for (const auto &cell : dof_handler.active_cell_iterators())
+      if (cell->is_locally_owned())
+        fe_degrees(cell->active_cell_index()) = cell->get_fe().degree;
+    data_out.add_data_vector(fe_degrees, "fe_degree");
+
+    Vector<float> subdomain(triangulation.n_active_cells());
+    for (unsigned int i = 0; i < subdomain.size(); ++i)
+      subdomain(i) = triangulation.locally_owned_subdomain();
+    data_out.add_data_vector(subdomain, "subdomain");
+
+    // With a higher-order mapping, every cell is subdivided so that the
+    // curved cells are shown as such. High-order cells are subdivided as
+    // often as the degree of the solution, and every cell is then written
+    // as one Lagrange cell of this degree instead of as many linear cells,
+    // which keeps the files small and shows the solution without
+    // interpolation errors.
+    unsigned int n_subdivisions =
+      (parameters.mapping_degree > 1 ? parameters.mapping_degree : 0);
+    if (parameters.high_order_output && parameters.output_format == "vtu")
+      n_subdivisions = std::max(n_subdivisions, fe.max_degree());
+    data_out.build_patches(mapping,
+                           n_subdivisions,
+                           DataOut<dim>::curved_inner_cells);
+
+    DataOutBase::VtkFlags vtk_flags;
+    vtk_flags.write_higher_order_cells = parameters.high_order_output;
+    if (parameters.output_compression == "none")
+      vtk_flags.compression_level = DataOutBase::VtkFlags::no_compression;
+    else if (parameters.output_compression == "best_speed")
+      vtk_flags.compression_level = DataOutBase::VtkFlags::best_speed;
+    else if (parameters.output_compression == "default")
+      vtk_flags.compression_level = DataOutBase::VtkFlags::default_compression;
+    else
+      vtk_flags.compression_level = DataOutBase::VtkFlags::best_compression;
+    data_out.set_flags(vtk_flags);
+
+    const unsigned int this_process =
+      Utilities::MPI::this_mpi_process(mpi_communicator);
+    const unsigned int n_processes =
+      Utilities::MPI::n_mpi_processes(mpi_communicator);
+    const std::string base_name =
+      "solution_" + Utilities::int_to_string(cycle, 2);
+
+    // Every file is measured by the process that wrote it, or by the first
+    // process if all processes wrote to it together.
+    const auto file_size = [](const std::string &filename) {
+      std::ifstream file(filename, std::ios::binary | std::ios::ate);
+      return static_cast<double>(file.tellg());
+    };
+    double       bytes_written = 0;
+    unsigned int n_files       = 0;
+
+    const auto start = std::chrono::steady_clock::now();
+
+    if (parameters.output_format == "hdf5")
+      {
+#ifdef DEAL_II_WITH_HDF5
+        // The values of a DG solution differ between the cells sharing a
+        // vertex, so the duplicate vertices must not be merged.
+        DataOutBase::DataOutFilter data_filter(
+          DataOutBase::DataOutFilterFlags(/*filter_duplicate_vertices=*/false,
+                                          /*xdmf_hdf5_output=*/true));
+        data_out.write_filtered_data(data_filter);
+        data_out.write_hdf5_parallel(data_filter,
+                                     base_name + ".h5",
+                                     mpi_communicator);
+
+        const std::vector<XDMFEntry> xdmf_entries = {
+          data_out.create_xdmf_entry(data_filter,
+                                     base_name + ".h5",
+                                     cycle,
+                                     mpi_communicator)};
+        data_out.write_xdmf_file(xdmf_entries,
+                                 base_name + ".xdmf",
+                                 mpi_communicator);
+
+        n_files = 2;
+        if (this_process == 0)
+          bytes_written =
+            file_size(base_name + ".h5") + file_size(base_name + ".xdmf");
+#else
+        AssertThrow(false,
+                    ExcMessage("HDF5 output requires deal.II to be "
+                               "configured with HDF5."));
+#endif
+      }
+    else if (parameters.output_files == "single")
+      {
+        data_out.write_vtu_in_parallel(base_name + ".vtu", mpi_communicator);
+
+        n_files = 1;
+        if (this_process == 0)
+          bytes_written = file_size(base_name + ".vtu");
+      }
+    else
+      {
+        // Every process writes its own part of the solution, and the first
+        // process writes the .pvtu record that ties these files together.
+        // Since no MPI is involved, these files can be written in the
+        // background, from a snapshot of the patches. The time and size of
+        // every background output are reported at the end of run(), when
+        // all of them are done.
+        const auto piece_name = [&base_name](const unsigned int process) {
+          return base_name + "." + Utilities::int_to_string(process, 4) +
+                 ".vtu";
+        };
+
+        std::vector<std::string> piece_names;
+        if (this_process == 0)
+          for (unsigned int process = 0; process < n_processes; ++process)
+            piece_names.push_back(piece_name(process));
+
+        const std::string piece  = piece_name(this_process);
+        const std::string record = base_name + ".pvtu";
+        const auto        write_files =
+          [piece, piece_names, record](const DataOutInterface<dim> &data) {
+            std::ofstream output(piece, std::ios::binary);
+            data.write_vtu(output);
+            double bytes = static_cast<double>(output.tellp());
+
+            if (!piece_names.empty())
+              {
+                std::ofstream record_output(record);
+                data.write_pvtu_record(record_output, piece_names);
+                bytes += static_cast<double>(record_output.tellp());
+              }
+            return bytes;
+          };
+
+        if (background_writer)
+          {
+            const std::shared_ptr<DataOutSnapshot<dim>> snapshot =
+              data_out.snapshot();
+            snapshot->set_flags(vtk_flags);
+            background_writer->submit(
+              base_name + " (" + parameters.output_format + ", " +
+                std::to_string(n_processes + 1) + " files)",
+              [snapshot, write_files]() { return write_files(*snapshot); });
+            return;
+          }
+
+        bytes_written = write_files(data_out);
+        n_files       = n_processes + 1;
+      }
+
+    const double write_time = Utilities::MPI::max(
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+        .count(),
+      mpi_communicator);
+    bytes_written = Utilities::MPI::sum(bytes_written, mpi_communicator);
+
+    pcout << "Output (" << parameters.output_format << ", " << n_files
+          << (n_files == 1 ? " file" : " files") << "): " << write_time
+          << " s, " << bytes_written / 1e6 << " MB" << std::endl;
+  }
+
+
+
+  // The mass matrix of the lifting space is block diagonal: the dim*dim
+  // components of a lifting are independent, and every block is the mass
+  // matrix of the scalar space of the same degree, i.e. of the space of the
+  // solution on the cell. Only this block is assembled and inverted, once
+  // per cell; its size is that of the lifting space divided by dim*dim,
+  // which matters in 3D, where the lifting space of a cell of degree 2 has
+  // 243 functions.
+  template <int dim, typename LinearAlgebra>
+  void BiLaplacianLDGLift<dim, LinearAlgebra>::assemble_mass_matrix_inverse(
+    const FEValues<dim> &fe_values,
+    FullMatrix<double> & mass_matrix_inverse) const
+  {
+    const unsigned int n_dofs = fe_values.dofs_per_cell;
+
+    mass_matrix_inverse.reinit(n_dofs, n_dofs);
+    for (unsigned int q = 0; q < fe_values.n_quadrature_points; ++q)
+      {
+        const double dx = fe_values.JxW(q);
+
+        for (unsigned int m = 0; m < n_dofs; ++m)
+          for (unsigned int n = 0; n < n_dofs; ++n)
+            mass_matrix_inverse(m, n) +=
+              fe_values.shape_value(n, q) * fe_values.shape_value(m, q) * dx;
+      }
+
+    mass_matrix_inverse.gauss_jordan();
+  }
+
+
+
+  // Solve for the coefficients of a lifting given the right hand side, by
+  // applying the inverse of the scalar mass matrix to every component.
+  template <int dim, typename LinearAlgebra>
+  void BiLaplacianLDGLift<dim, LinearAlgebra>::apply_mass_matrix_inverse(
+    const FiniteElement<dim> &fe_lift,
+    const FullMatrix<double> &mass_matrix_inverse,
+    const Vector<double> &    rhs_lift,
+    Vector<double> &          coeffs_lift) const
+  {
+    for (unsigned int m = 0; m < fe_lift.n_dofs_per_cell(); ++m)
+      {
+        const std::pair<unsigned int, unsigned int> component =
+          fe_lift.system_to_component_index(m);
+
+        coeffs_lift(m) = 0;
+        for (unsigned int l = 0; l < mass_matrix_inverse.n(); ++l)
+          coeffs_lift(m) +=
+            mass_matrix_inverse(component.second, l) *
+            rhs_lift(fe_lift.component_to_system_index(component.first, l));
+      }
+  }
+
+
+
+  // The discrete Hessians of the shape functions of the cell, and the parts
+  // of the discrete Hessians of the shape functions of every neighbor that
+  // live on the cell: the liftings of their jumps across the part of the
+  // face they share with the cell. This part is the whole face if the
+  // neighbor is on the same level or coarser, and a child of the face if
+  // the face is refined. The liftings live in the lifting space of the
+  // degree of the cell, while the shape functions of a neighbor may have
+  // another degree; the shared part of the face is then integrated with the
+  // quadrature rule of the higher degree.
+  //
+  // The liftings are linear in their right hand sides. The right hand sides
+  // of all faces of the cell are therefore added up before the mass matrix
+  // is inverted, and the lifting of the jump of the gradient, which enters
+  // the discrete Hessian with a minus sign, is combined with that of the
+  // jump of the value. Every face is visited once for all shape functions,
+  // and there is one lifting per shape function of the cell and of each
+  // neighbor.
+  template <int dim, typename LinearAlgebra>
+  void BiLaplacianLDGLift<dim, LinearAlgebra>::compute_discrete_hessians(
+    const typename DoFHandler<dim>::active_cell_iterator &cell,
+    const std::vector<FaceNeighbor<dim>> &                neighbors,
+    Assembly::Scratch::Lifting<dim> &                     scratch_data,
+    std::vector<std::vector<Tensor<2, dim>>> &            discrete_hessians,
+    std::vector<std::vector<std::vector<Tensor<2, dim>>>>
+      &discrete_hessians_neigh)
+  {
+    const typename Triangulation<dim>::cell_iterator cell_lift =
+      static_cast<typename Triangulation<dim>::cell_iterator>(cell);
+    const unsigned int fe_index = cell->active_fe_index();
+
+    hp::FEFaceValues<dim> &   fe_face_neighbor = scratch_data.fe_face_neighbor;
+    hp::FESubfaceValues<dim> &fe_subface_neighbor =
+      scratch_data.fe_subface_neighbor;
+
+    hp::FEFaceValues<dim> &   fe_face_lift    = scratch_data.fe_face_lift;
+    hp::FESubfaceValues<dim> &fe_subface_lift = scratch_data.fe_subface_lift;
+
+    scratch_data.fe_values.reinit(cell);
+    const FEValues<dim> &fe_values =
+      scratch_data.fe_values.get_present_fe_values();
+
+    scratch_data.fe_values_lift.reinit(cell_lift,
+                                       fe_index,
+                                       numbers::invalid_unsigned_int,
+                                       fe_index);
+    const FEValues<dim> &fe_values_lift =
+      scratch_data.fe_values_lift.get_present_fe_values();
+
+    const unsigned int n_q_points = fe_values.n_quadrature_points;
+
+    const unsigned int n_dofs = fe_values.dofs_per_cell;
+
+    const FEValuesExtractors::Tensor<2> tau_ext(0);
+
+    const unsigned int n_dofs_lift = fe_values_lift.dofs_per_cell;
+
+    FullMatrix<double> &mass_matrix_inverse = scratch_data.mass_matrix_inverse;
+    FullMatrix<double> &local_rhs           = scratch_data.local_rhs;
+    Vector<double> &    rhs_lift            = scratch_data.rhs_lift;
+    Vector<double> &    coeffs_lift         = scratch_data.coeffs_lift;
+
+    double factor_avg; // 0.5 for interior faces, 1.0 for boundary faces
+
+    // On the meshes generated by make_grid() without distortion, all cells
+    // are squares or cubes with faces parallel to the axes. The discrete
+    // Hessians on such a cell are those on a cell of size 1 divided by the
+    // square of its size, and only depend on the configuration of its
+    // faces: which of them are at the boundary, and for every neighbor, the
+    // faces and subfaces the cell and the neighbor share and the degrees of
+    // both. They are therefore computed once per configuration, by the
+    // first thread to meet it, and stored in the reference data, where all
+    // threads and all problems of the same degrees find them; on all other
+    // cells with the same configuration, they are only scaled. (Two threads
+    // meeting a new configuration at once both compute it, and the first to
+    // finish stores it.) In particular, the liftings across the children of a
+    // refined face, of which a coarse cell next to finer ones has several,
+    // are computed once per child and not once per face. The mass matrix is
+    // only assembled if one of the liftings of the cell is not known yet.
+    const bool cartesian_mesh =
+      (parameters.mesh_file.empty() && parameters.mesh_distortion == 0);
+    const double size_squared = std::pow(cell->extent_in_direction(0), 2);
+
+    bool       mass_matrix_assembled = false;
+    const auto assemble_mass_matrix  = [&]() {
+      if (!mass_matrix_assembled)
+        {
+          assemble_mass_matrix_inverse(fe_values, mass_matrix_inverse);
+          mass_matrix_assembled = true;
+        }
+    };
+
+    rhs_lift.reinit(n_dofs_lift);
+    coeffs_lift.reinit(n_dofs_lift);
+
+    // The liftings of the neighbors are stored for as many neighbors and
+    // shape functions as the cells seen so far needed. This is much less
+    // than the largest possible number of neighbors, in particular in 3D,
+    // where a cell has up to 24 neighbors across its refined faces.
+    for (unsigned int i = 0; i < n_dofs; ++i)
+      for (unsigned int q = 0; q < n_q_points; ++q)
+        discrete_hessians[i][q] = 0;
+
+    if (discrete_hessians_neigh.size() < neighbors.size())
+      discrete_hessians_neigh.resize(neighbors.size());
+    for (unsigned int n = 0; n < neighbors.size(); ++n)
+      {
+        const unsigned int n_dofs_neigh =
+          neighbors[n].cell->get_fe().n_dofs_per_cell();
+        if (discrete_hessians_neigh[n].size() < n_dofs_neigh)
+          discrete_hessians_neigh[n].resize(n_dofs_neigh);
+        for (unsigned int i = 0; i < n_dofs_neigh; ++i)
+          {
+            if (discrete_hessians_neigh[n][i].size() < n_q_points)
+              discrete_hessians_neigh[n][i].resize(n_q_points);
+            for (unsigned int q = 0; q < n_q_points; ++q)
+              discrete_hessians_neigh[n][i][q] = 0;
+          }
+      }
+
+    unsigned int boundary_faces = 0;
+    for (const unsigned int face_no : cell->face_indices())
+      if (cell->at_boundary(face_no))
+        boundary_faces |= (1U << face_no);
+
+    const std::pair<unsigned int, unsigned int> cell_configuration(
+      fe_index, boundary_faces);
+    const std::vector<std::vector<Tensor<2, dim>>> *cached_cell_lifting =
+      (cartesian_mesh ?
+         reference_data->cell_liftings.find(cell_configuration) :
+         nullptr);
+
+    if (cached_cell_lifting)
+      {
+        for (unsigned int i = 0; i < n_dofs; ++i)
+          for (unsigned int q = 0; q < n_q_points; ++q)
+            discrete_hessians[i][q] =
+              (*cached_cell_lifting)[i][q] / size_squared;
+      }
+    else
+      {
+        assemble_mass_matrix();
+
+        local_rhs.reinit(n_dofs, n_dofs_lift);
+        for (unsigned int face_no = 0; face_no < cell->n_faces(); ++face_no)
+          {
+            const typename DoFHandler<dim>::face_iterator face =
+              cell->face(face_no);
+
+            const bool at_boundary = face->at_boundary();
+
+            factor_avg = 0.5;
+            if (at_boundary)
+              {
+                factor_avg = 1.0;
+              }
+
+            scratch_data.fe_face.reinit(cell, face_no);
+            const FEFaceValues<dim> &fe_face =
+              scratch_data.fe_face.get_present_fe_values();
+            const FEFaceValuesBase<dim> &fe_face_own_lift =
+              reinit_face_values(cell_lift,
+                                 face_no,
+                                 numbers::invalid_unsigned_int,
+                                 fe_index,
+                                 fe_index,
+                                 fe_face_lift,
+                                 fe_subface_lift);
+
+            for (unsigned int q = 0; q < fe_face.n_quadrature_points; ++q)
               {
-                for (unsigned int j = 0; j < n_dofs; ++j)
+                const double         dx     = fe_face_own_lift.JxW(q);
+                const Tensor<1, dim> normal = fe_face.normal_vector(
+                  q); // same as fe_face_own_lift.normal_vector(q)
+
+                for (unsigned int m = 0; m < n_dofs_lift; ++m)
                   {
-                    matrix(local_dof_indices[i], local_dof_indices[j]) +=
-                      ip_matrix_cc(i, j);
+                    const Tensor<1, dim> tau_n =
+                      fe_face_own_lift[tau_ext].value(m, q) * normal;
+                    const double div_tau_n =
+                      fe_face_own_lift[tau_ext].divergence(m, q) * normal;
+
+                    for (unsigned int i = 0; i < n_dofs; ++i)
+                      local_rhs(i, m) +=
+                        factor_avg *
+                        (div_tau_n * fe_face.shape_value(i, q) -
+                         tau_n * fe_face.shape_grad(i, q)) *
+                        dx;
                   }
               }
+          } // for face
+
+        for (unsigned int i = 0; i < n_dofs; ++i)
+          {
+            for (unsigned int m = 0; m < n_dofs_lift; ++m)
+              rhs_lift(m) = local_rhs(i, m);
+            apply_mass_matrix_inverse(fe_values_lift.get_fe(),
+                                      mass_matrix_inverse,
+                                      rhs_lift,
+                                      coeffs_lift);
+
+            for (unsigned int q = 0; q < n_q_points; ++q)
+              {
+                discrete_hessians[i][q] += fe_values.shape_hessian(i, q);
+
+                for (unsigned int m = 0; m < n_dofs_lift; ++m)
+                  discrete_hessians[i][q] +=
+                    coeffs_lift[m] * fe_values_lift[tau_ext].value(m, q);
+              }
+          } // for dof i
+
+        if (cartesian_mesh)
+          {
+            std::vector<std::vector<Tensor<2, dim>>> cached(
+              n_dofs, std::vector<Tensor<2, dim>>(n_q_points));
+            for (unsigned int i = 0; i < n_dofs; ++i)
+              for (unsigned int q = 0; q < n_q_points; ++q)
+                cached[i][q] = discrete_hessians[i][q] * size_squared;
+            reference_data->cell_liftings.insert(cell_configuration,
+                                                 std::move(cached));
+          }
+      }
+
+
+
+    for (unsigned int n = 0; n < neighbors.size(); ++n)
+      {
+        const FaceNeighbor<dim> &neighbor = neighbors[n];
+
+        const unsigned int q_index =
+          face_quadrature_index<dim>(cell, neighbor.cell);
+
+        const std::array<unsigned int, 7> neighbor_configuration = {
+          {fe_index,
+           neighbor.cell->active_fe_index(),
+           q_index,
+           neighbor.face_no,
+           neighbor.subface_no,
+           neighbor.neighbor_face_no,
+           neighbor.neighbor_subface_no}};
+        const std::vector<std::vector<Tensor<2, dim>>>
+          *cached_neighbor_lifting =
+            (cartesian_mesh ?
+               reference_data->neighbor_liftings.find(neighbor_configuration) :
+               nullptr);
+
+        if (cached_neighbor_lifting)
+          {
+            const std::vector<std::vector<Tensor<2, dim>>> &cached =
+              *cached_neighbor_lifting;
+            for (unsigned int i = 0; i < cached.size(); ++i)
+              for (unsigned int q = 0; q < n_q_points; ++q)
+                discrete_hessians_neigh[n][i][q] = cached[i][q] / size_squared;
+            continue;
+          }
+
+        assemble_mass_matrix();
+
+        const FEFaceValuesBase<dim> &fe_face_shared_lift =
+          reinit_face_values(cell_lift,
+                             neighbor.face_no,
+                             neighbor.subface_no,
+                             q_index,
+                             fe_index,
+                             fe_face_lift,
+                             fe_subface_lift);
+        const FEFaceValuesBase<dim> &fe_face_neigh =
+          reinit_face_values(neighbor.cell,
+                             neighbor.neighbor_face_no,
+                             neighbor.neighbor_subface_no,
+                             q_index,
+                             numbers::invalid_unsigned_int,
+                             fe_face_neighbor,
+                             fe_subface_neighbor);
+
+        const unsigned int n_dofs_neigh = fe_face_neigh.dofs_per_cell;
+
+        local_rhs.reinit(n_dofs_neigh, n_dofs_lift);
+        for (unsigned int q = 0; q < fe_face_neigh.n_quadrature_points; ++q)
+          {
+            const double         dx     = fe_face_shared_lift.JxW(q);
+            const Tensor<1, dim> normal = fe_face_neigh.normal_vector(q);
 
-            if (!at_boundary)
+            for (unsigned int m = 0; m < n_dofs_lift; ++m)
               {
-                for (unsigned int i = 0; i < n_dofs; ++i)
-                  {
-                    for (unsigned int j = 0; j < n_dofs; ++j)
-                      {
-                        matrix(local_dof_indices[i],
-                               local_dof_indices_neighbor[j]) +=
-                          ip_matrix_cn(i, j);
-                        matrix(local_dof_indices_neighbor[i],
-                               local_dof_indices[j]) += ip_matrix_nc(i, j);
-                        matrix(local_dof_indices_neighbor[i],
-                               local_dof_indices_neighbor[j]) +=
-                          ip_matrix_nn(i, j);
-                      }
-                  }
+                const Tensor<1, dim> tau_n =
+                  fe_face_shared_lift[tau_ext].value(m, q) * normal;
+                const double div_tau_n =
+                  fe_face_shared_lift[tau_ext].divergence(m, q) * normal;
+
+                for (unsigned int i = 0; i < n_dofs_neigh; ++i)
+                  local_rhs(i, m) +=
+                    0.5 *
+                    (div_tau_n * fe_face_neigh.shape_value(i, q) -
+                     tau_n * fe_face_neigh.shape_grad(i, q)) *
+                    dx;
               }
+          }
 
-          } // for face
-      }     // for cell
+        for (unsigned int i = 0; i < n_dofs_neigh; ++i)
+          {
+            for (unsigned int m = 0; m < n_dofs_lift; ++m)
+              rhs_lift(m) = local_rhs(i, m);
+            apply_mass_matrix_inverse(fe_values_lift.get_fe(),
+                                      mass_matrix_inverse,
+                                      rhs_lift,
+                                      coeffs_lift);
+
+            for (unsigned int q = 0; q < n_q_points; ++q)
+              for (unsigned int m = 0; m < n_dofs_lift; ++m)
+                discrete_hessians_neigh[n][i][q] +=
+                  coeffs_lift[m] * fe_values_lift[tau_ext].value(m, q);
+          } // for dof i
+
+        if (cartesian_mesh)
+          {
+            std::vector<std::vector<Tensor<2, dim>>> cached(
+              n_dofs_neigh, std::vector<Tensor<2, dim>>(n_q_points));
+            for (unsigned int i = 0; i < n_dofs_neigh; ++i)
+              for (unsigned int q = 0; q < n_q_points; ++q)
+                cached[i][q] = discrete_hessians_neigh[n][i][q] * size_squared;
+            reference_data->neighbor_liftings.insert(neighbor_configuration,
+                                                     std::move(cached));
+          }
+      } // for neighbor
   }
 
 
 
-  template <int dim>
-  void BiLaplacianLDGLift<dim>::assemble_rhs()
+  template <int dim, typename LinearAlgebra>
+  void BiLaplacianLDGLift<dim, LinearAlgebra>::run()
   {
-    rhs = 0;
+    // The wall times of the phases up to the end of the previous cycle,
+    // which are subtracted from the totals of the timer to get those of
+    // every cycle.
+    std::vector<double> previous_wall_times(timed_phases.size(), 0.);
 
-    const QGauss<dim> quad(fe.degree + 1);
-    FEValues<dim>     fe_values(
-      fe, quad, update_values | update_quadrature_points | update_JxW_values);
+    cycle_results.clear();
+    for (unsigned int cycle = 0; cycle < parameters.n_cycles; ++cycle)
+      {
+        pcout << "Cycle " << cycle << ':' << std::endl;
 
-    const unsigned int n_dofs     = fe_values.dofs_per_cell;
-    const unsigned int n_quad_pts = quad.size();
+        if (cycle == 0)
+          {
+            TimerOutput::Scope t(computing_timer, "Make grid");
+            make_grid();
+          }
+        else
+          {
+            TimerOutput::Scope t(computing_timer, "Refine grid");
+            refine_grid();
+          }
 
-    const RightHandSide<dim> right_hand_side;
+        {
+          TimerOutput::Scope t(computing_timer, "Setup system");
+          setup_system();
+        }
+        assemble_system();
+        if (parameters.n_benchmark_products > 0)
+          benchmark_matrix_vector_product();
 
-    Vector<double>                       local_rhs(n_dofs);
-    std::vector<types::global_dof_index> local_dof_indices(n_dofs);
+        {
+          TimerOutput::Scope t(computing_timer, "Solve");
+          solve();
+        }
 
-    for (const auto &cell : dof_handler.active_cell_iterators())
-      {
-        fe_values.reinit(cell);
-        cell->get_dof_indices(local_dof_indices);
+        {
+          TimerOutput::Scope t(computing_timer, "Compute errors");
+          errors = compute_errors();
+        }
+        pcout << "DG H2 norm of the error: " << errors.H2 << std::endl;
+        pcout << "DG H1 norm of the error: " << errors.H1 << std::endl;
+        pcout << "   L2 norm of the error: " << errors.L2 << std::endl;
+        if (parameters.refinement != "global")
+          {
+            TimerOutput::Scope t(computing_timer, "Estimate error");
+            estimate_error();
+          }
+        if (!quiet)
+          {
+            TimerOutput::Scope t(computing_timer, "Output results");
+            output_results(cycle);
+          }
 
-        local_rhs = 0;
-        for (unsigned int q = 0; q < n_quad_pts; ++q)
+        CycleResults results;
+        results.n_cells = triangulation.n_global_active_cells();
+        results.n_dofs  = dof_handler.n_dofs();
+        results.errors  = errors;
+
+        const std::map<std::string, double> wall_times =
+          computing_timer.get_summary_data(TimerOutput::total_wall_time);
+        for (unsigned int i = 0; i < timed_phases.size(); ++i)
           {
-            const double dx = fe_values.JxW(q);
+            const auto   time  = wall_times.find(timed_phases[i]);
+            const double total = (time != wall_times.end() ? time->second : 0.);
+            results.wall_times.push_back(
+              Utilities::MPI::max(total - previous_wall_times[i],
+                                  mpi_communicator));
+            previous_wall_times[i] = total;
+          }
+        cycle_results.push_back(results);
+      }
 
-            for (unsigned int i = 0; i < n_dofs; ++i)
-              {
-                local_rhs(i) +=
-                  right_hand_side.value(fe_values.quadrature_point(q)) *
-                  fe_values.shape_value(i, q) * dx;
-              }
+    // The outputs still written in the background are waited for as part
+    // of the output phase. Every process submitted the same outputs in the
+    // same order, so their times and sizes can be reduced one by one and
+    // are reported like those written directly, followed by the total.
+    if (background_writer)
+      {
+        {
+          TimerOutput::Scope t(computing_timer, "Output results");
+          background_writer->flush();
+        }
+
+        double total_write_time = 0;
+        double total_bytes      = 0;
+        for (const auto &task : background_writer->finished_tasks)
+          {
+            const double write_time =
+              Utilities::MPI::max(task.time, mpi_communicator);
+            const double bytes_written =
+              Utilities::MPI::sum(task.bytes, mpi_communicator);
+            pcout << "Output " << task.name << " in the background: "
+                  << write_time << " s, " << bytes_written / 1e6 << " MB"
+                  << std::endl;
+
+            total_write_time += task.time;
+            total_bytes += bytes_written;
           }
 
-        for (unsigned int i = 0; i < n_dofs; ++i)
-          rhs(local_dof_indices[i]) += local_rhs(i);
+        const Utilities::MPI::MinMaxAvg write_time =
+          Utilities::MPI::min_max_avg(total_write_time, mpi_communicator);
+        const Utilities::MPI::MinMaxAvg hidden_time =
+          Utilities::MPI::min_max_avg(
+            std::max(total_write_time - background_writer->wait_time, 0.),
+            mpi_communicator);
+        pcout << "Background output: "
+              << background_writer->finished_tasks.size()
+              << " outputs per process, " << total_bytes / 1e6 << " MB, "
+              << write_time.max << " s writing (max), of which "
+              << hidden_time.avg << " s hidden behind the computation (avg)"
+              << std::endl;
       }
+
+    // The peak memory of the processes over the whole run. In 3D, it is
+    // dominated by the matrix, whose rows have several times as many
+    // entries as in 2D, and by the sparse direct solver, if used.
+    Utilities::System::MemoryStats memory_stats;
+    Utilities::System::get_memory_stats(memory_stats);
+    const Utilities::MPI::MinMaxAvg peak_memory =
+      Utilities::MPI::min_max_avg(memory_stats.VmHWM / 1024.,
+                                  mpi_communicator);
+    pcout << "Peak memory per process: " << peak_memory.max << " MB (max), "
+          << peak_memory.avg << " MB (avg)" << std::endl;
+
+    if (!quiet && !parameters.timing_output_file.empty())
+      write_timings();
   }
 
 
 
-  template <int dim>
-  void BiLaplacianLDGLift<dim>::solve()
+  template <int dim, typename LinearAlgebra>
+  types::global_dof_index BiLaplacianLDGLift<dim, LinearAlgebra>::n_dofs() const
   {
-    SparseDirectUMFPACK A_direct;
-    A_direct.initialize(matrix);
-    A_direct.vmult(solution, rhs);
+    return dof_handler.n_dofs();
   }
 
 
 
-  template <int dim>
-  void BiLaplacianLDGLift<dim>::compute_errors()
+  template <int dim, typename LinearAlgebra>
+  const ErrorNorms &BiLaplacianLDGLift<dim, LinearAlgebra>::get_errors() const
   {
-    double error_H2 = 0;
-    double error_H1 = 0;
-    double error_L2 = 0;
-
-    QGauss<dim>     quad(fe.degree + 1);
-    QGauss<dim - 1> quad_face(fe.degree + 1);
-
-    FEValues<dim> fe_values(fe,
-                            quad,
-                            update_values | update_gradients | update_hessians |
-                              update_quadrature_points | update_JxW_values);
+    return errors;
+  }
 
-    FEFaceValues<dim> fe_face(fe,
-                              quad_face,
-                              update_values | update_gradients |
-                                update_quadrature_points | update_JxW_values);
 
-    FEFaceValues<dim> fe_face_neighbor(fe,
-                                       quad_face,
-                                       update_values | update_gradients);
 
-    const unsigned int n_q_points      = quad.size();
-    const unsigned int n_q_points_face = quad_face.size();
+  template <int dim, typename LinearAlgebra>
+  const std::vector<CycleResults> &
+  BiLaplacianLDGLift<dim, LinearAlgebra>::get_cycle_results() const
+  {
+    return cycle_results;
+  }
 
-    const ExactSolution<dim> u_exact;
 
-    std::vector<double>         solution_values_cell(n_q_points);
-    std::vector<Tensor<1, dim>> solution_gradients_cell(n_q_points);
-    std::vector<Tensor<2, dim>> solution_hessians_cell(n_q_points);
 
-    std::vector<double>         solution_values(n_q_points_face);
-    std::vector<double>         solution_values_neigh(n_q_points_face);
-    std::vector<Tensor<1, dim>> solution_gradients(n_q_points_face);
-    std::vector<Tensor<1, dim>> solution_gradients_neigh(n_q_points_face);
+  // Append the wall time of every phase of the run to the timing output
+  // file, as one line of comma separated values. The time of a phase is
+  // the largest time over all processes. The time spent communicating in
+  // the assembly of the matrix and in the computation of the errors, which
+  // is part of these phases, follows after the total. With several cycles
+  // of refinement, the times are summed over the cycles and the size is
+  // that of the last mesh. The file is read by scaling_study.sh, which
+  // collects the runs of a scaling study.
+  template <int dim, typename LinearAlgebra>
+  void BiLaplacianLDGLift<dim, LinearAlgebra>::write_timings() const
+  {
+    const std::map<std::string, double> wall_times =
+      computing_timer.get_summary_data(TimerOutput::total_wall_time);
 
-    for (const auto &cell : dof_handler.active_cell_iterators())
+    std::vector<double> times;
+    for (const auto &phase : timed_phases)
       {
-        fe_values.reinit(cell);
+        const auto time = wall_times.find(phase);
+        times.push_back(Utilities::MPI::max(
+          time != wall_times.end() ? time->second : 0., mpi_communicator));
+      }
 
-        fe_values.get_function_values(solution, solution_values_cell);
-        fe_values.get_function_gradients(solution, solution_gradients_cell);
-        fe_values.get_function_hessians(solution, solution_hessians_cell);
+    if (Utilities::MPI::this_mpi_process(mpi_communicator) != 0)
+      return;
 
-        for (unsigned int q = 0; q < n_q_points; ++q)
-          {
-            const double dx = fe_values.JxW(q);
+    std::ifstream existing(parameters.timing_output_file);
+    const bool    write_header =
+      (existing.peek() == std::ifstream::traits_type::eof());
+    std::ofstream out(parameters.timing_output_file, std::ios::app);
 
-            error_H2 += (u_exact.hessian(fe_values.quadrature_point(q)) -
-                         solution_hessians_cell[q])
-                          .norm_square() *
-                        dx;
-            error_H1 += (u_exact.gradient(fe_values.quadrature_point(q)) -
-                         solution_gradients_cell[q])
-                          .norm_square() *
-                        dx;
-            error_L2 += std::pow(u_exact.value(fe_values.quadrature_point(q)) -
-                                   solution_values_cell[q],
-                                 2) *
-                        dx;
-          } // for quadrature points
+    if (write_header)
+      {
+        out << "processes,threads,refinements,degree,dofs";
+        for (unsigned int i = 0; i < n_main_timed_phases; ++i)
+          out << ',' << phase_column_name(timed_phases[i]);
+        out << ",total";
+        for (unsigned int i = n_main_timed_phases; i < timed_phases.size();
+             ++i)
+          out << ',' << phase_column_name(timed_phases[i]);
+        out << '\n';
+      }
 
-        for (unsigned int face_no = 0; face_no < cell->n_faces(); ++face_no)
-          {
-            const typename DoFHandler<dim>::face_iterator face =
-              cell->face(face_no);
+    out << Utilities::MPI::n_mpi_processes(mpi_communicator) << ','
+        << MultithreadInfo::n_threads() << ',' << n_refinements << ','
+        << fe[0].degree << ',' << dof_handler.n_dofs();
+    for (unsigned int i = 0; i < n_main_timed_phases; ++i)
+      out << ',' << times[i];
+    out << ','
+        << std::accumulate(times.begin(),
+                           times.begin() + n_main_timed_phases,
+                           0.);
+    for (unsigned int i = n_main_timed_phases; i < timed_phases.size(); ++i)
+      out << ',' << times[i];
+    out << '\n';
+  }
 
-            const double mesh_inv = 1.0 / face->diameter(); // h^{-1}
-            const double mesh3_inv =
-              1.0 / std::pow(face->diameter(), 3); // h^{-3}
 
-            fe_face.reinit(cell, face_no);
 
-            fe_face.get_function_values(solution, solution_values);
-            fe_face.get_function_gradients(solution, solution_gradients);
+#ifdef STEP82_WITH_THREAD_PINNING
+  // Pin every thread that joins the TBB thread pool to its own core. The
+  // cores are taken from the NUMA nodes in turn, as listed by the kernel in
+  // /sys/devices/system/node, so that fewer threads than cores are spread
+  // over all nodes rather than filling the first one, whose cores usually
+  // come first in the numbering. Only cores in the affinity mask of the
+  // process are used, so a binding of the MPI processes by the
+  // launcher (for instance "mpirun --bind-to numa") is respected. A pinned
+  // thread is not moved away from the memory it touched first, such as its
+  // scratch data, which WorkStream creates on the thread itself.
+  class ThreadPinning : public tbb::task_scheduler_observer
+  {
+  public:
+    ThreadPinning()
+      : next_core(0)
+    {
+      cpu_set_t process_cores;
+      CPU_ZERO(&process_cores);
+      sched_getaffinity(0, sizeof(process_cores), &process_cores);
 
-            const bool at_boundary = face->at_boundary();
-            if (at_boundary)
-              {
-                for (unsigned int q = 0; q < n_q_points_face; ++q)
-                  {
-                    const double dx = fe_face.JxW(q);
-                    const double u_exact_q =
-                      u_exact.value(fe_face.quadrature_point(q));
-                    const Tensor<1, dim> u_exact_grad_q =
-                      u_exact.gradient(fe_face.quadrature_point(q));
-
-                    error_H2 +=
-                      mesh_inv *
-                      (u_exact_grad_q - solution_gradients[q]).norm_square() *
-                      dx;
-                    error_H2 += mesh3_inv *
-                                std::pow(u_exact_q - solution_values[q], 2) *
-                                dx;
-                    error_H1 += mesh_inv *
-                                std::pow(u_exact_q - solution_values[q], 2) *
-                                dx;
-                  }
-              }
-            else
-              { // interior face
+      std::vector<std::vector<int>> node_cores;
+      for (const int node : read_list("/sys/devices/system/node/possible"))
+        {
+          std::vector<int> cores_of_node;
+          for (const int core :
+               read_list("/sys/devices/system/node/node" +
+                         std::to_string(node) + "/cpulist"))
+            if (core < CPU_SETSIZE && CPU_ISSET(core, &process_cores))
+              cores_of_node.push_back(core);
+          if (!cores_of_node.empty())
+            node_cores.push_back(cores_of_node);
+        }
 
-                const typename DoFHandler<dim>::active_cell_iterator
-                                   neighbor_cell = cell->neighbor(face_no);
-                const unsigned int face_no_neighbor =
-                  cell->neighbor_of_neighbor(face_no);
+      // Without information on the nodes, all cores form a single node.
+      if (node_cores.empty())
+        {
+          node_cores.emplace_back();
+          for (int core = 0; core < CPU_SETSIZE; ++core)
+            if (CPU_ISSET(core, &process_cores))
+              node_cores.back().push_back(core);
+        }
 
-                if (neighbor_cell->id() < cell->id())
-                  continue; // skip this face (already considered)
-                else
-                  {
-                    fe_face_neighbor.reinit(neighbor_cell, face_no_neighbor);
-
-                    fe_face.get_function_values(solution, solution_values);
-                    fe_face_neighbor.get_function_values(solution,
-                                                         solution_values_neigh);
-                    fe_face.get_function_gradients(solution,
-                                                   solution_gradients);
-                    fe_face_neighbor.get_function_gradients(
-                      solution, solution_gradients_neigh);
-
-                    for (unsigned int q = 0; q < n_q_points_face; ++q)
-                      {
-                        const double dx = fe_face.JxW(q);
-
-                        error_H2 +=
-                          mesh_inv *
-                          (solution_gradients_neigh[q] - solution_gradients[q])
-                            .norm_square() *
-                          dx;
-                        error_H2 += mesh3_inv *
-                                    std::pow(solution_values_neigh[q] -
-                                               solution_values[q],
-                                             2) *
-                                    dx;
-                        error_H1 += mesh_inv *
-                                    std::pow(solution_values_neigh[q] -
-                                               solution_values[q],
-                                             2) *
-                                    dx;
-                      }
-                  } // face not visited yet
-
-              } // boundary check
+      // One core of every node in turn.
+      for (unsigned int i = 0;; ++i)
+        {
+          const std::size_t n_cores = cores.size();
+          for (const auto &cores_of_node : node_cores)
+            if (i < cores_of_node.size())
+              cores.push_back(cores_of_node[i]);
+          if (cores.size() == n_cores)
+            break;
+        }
 
-          } // for face
+      observe(true);
+    }
 
-      } // for cell
+    ~ThreadPinning()
+    {
+      observe(false);
+    }
 
-    error_H2 = std::sqrt(error_H2);
-    error_H1 = std::sqrt(error_H1);
-    error_L2 = std::sqrt(error_L2);
+    // TBB calls this function whenever a thread enters the arena, which a
+    // worker does again after every time it was idle. The core of a thread
+    // is therefore chosen on its first entry only and remembered, so that
+    // every thread keeps its core and no two threads share one.
+    virtual void on_scheduler_entry(bool /*is_worker*/) override
+    {
+      thread_local bool pinned = false;
+      if (pinned || cores.empty())
+        return;
+
+      cpu_set_t core;
+      CPU_ZERO(&core);
+      CPU_SET(cores[next_core++ % cores.size()], &core);
+      sched_setaffinity(0, sizeof(core), &core);
+      pinned = true;
+    }
 
-    std::cout << "DG H2 norm of the error: " << error_H2 << std::endl;
-    std::cout << "DG H1 norm of the error: " << error_H1 << std::endl;
-    std::cout << "   L2 norm of the error: " << error_L2 << std::endl;
-  }
+  private:
+    // Read a list of numbers such as "0-3,8-11" from the first line of a
+    // file; the list is empty if the file does not exist.
+    static std::vector<int> read_list(const std::string &file_name)
+    {
+      std::ifstream in(file_name);
+      std::string   line;
+      std::getline(in, line);
+
+      std::vector<int>   numbers;
+      std::istringstream ranges(line);
+      std::string        range;
+      while (std::getline(ranges, range, ','))
+        if (!range.empty())
+          {
+            const std::size_t dash  = range.find('-');
+            const int         first = std::stoi(range.substr(0, dash));
+            const int         last =
+              (dash == std::string::npos ? first :
+                                           std::stoi(range.substr(dash + 1)));
+            for (int n = first; n <= last; ++n)
+              numbers.push_back(n);
+          }
+      return numbers;
+    }
+
+    std::vector<int>          cores;
+    std::atomic<unsigned int> next_core;
+  };
+#endif
 
 
 
+  // The reference data for the polynomial degree of the initial mesh and,
+  // in hp refinement, for all higher degrees up to the maximal one. The
+  // transfer of the solution between cells of different degrees needs the
+  // interpolation between the elements, which only FE_DGQ provides.
   template <int dim>
-  void BiLaplacianLDGLift<dim>::output_results() const
+  std::shared_ptr<const ReferenceData<dim>>
+  make_reference_data(const Parameters &parameters)
   {
-    DataOut<dim> data_out;
-    data_out.attach_dof_handler(dof_handler);
-    data_out.add_data_vector(solution, "solution");
-    data_out.build_patches();
+    AssertThrow(parameters.refinement != "hp" ||
+                  parameters.polynomial_space == "Q",
+                ExcMessage("hp refinement requires the polynomial space Q."));
 
-    std::ofstream output("solution.vtk");
-    data_out.write_vtk(output);
+    const unsigned int max_degree =
+      (parameters.refinement == "hp" ?
+         std::max(parameters.fe_degree, parameters.max_fe_degree) :
+         parameters.fe_degree);
+
+    return std::make_shared<const ReferenceData<dim>>(
+      parameters.polynomial_space, parameters.fe_degree, max_degree);
   }
 
 
 
+  // Create the problem with the linear algebra backend selected in the
+  // parameter file, run it and return the results of its cycles. Backends
+  // that deal.II was not configured with are reported as an error.
   template <int dim>
-  void BiLaplacianLDGLift<dim>::assemble_local_matrix(
-    const FEValues<dim> &fe_values_lift,
-    const unsigned int   n_q_points,
-    FullMatrix<double> & local_matrix)
+  std::vector<CycleResults> run_problem(const Parameters &parameters,
+                                        const bool        quiet = false)
   {
-    const FEValuesExtractors::Tensor<2> tau_ext(0);
+    const auto reference_data = make_reference_data<dim>(parameters);
 
-    const unsigned int n_dofs = fe_values_lift.dofs_per_cell;
-
-    local_matrix = 0;
-    for (unsigned int q = 0; q < n_q_points; ++q)
+    std::string backend = parameters.linear_algebra_backend;
+    if (backend == "auto")
       {
-        const double dx = fe_values_lift.JxW(q);
+        if (Utilities::MPI::n_mpi_processes(MPI_COMM_WORLD) == 1)
+          backend = "dealii";
+        else
+          {
+#if defined(STEP82_WITH_PETSC)
+            backend = "petsc";
+#elif defined(DEAL_II_WITH_TRILINOS)
+            backend = "trilinos";
+#endif
+          }
+      }
 
-        for (unsigned int m = 0; m < n_dofs; ++m)
-          for (unsigned int n = 0; n < n_dofs; ++n)
-            {
-              local_matrix(m, n) +=
-                scalar_product(fe_values_lift[tau_ext].value(n, q),
-                               fe_values_lift[tau_ext].value(m, q)) *
-                dx;
-            }
+    if (backend == "dealii")
+      {
+        BiLaplacianLDGLift<dim, LinearAlgebraBackends::DealII> problem(
+          parameters, reference_data, MPI_COMM_WORLD, quiet);
+        problem.run();
+        return problem.get_cycle_results();
+      }
+#ifdef STEP82_WITH_PETSC
+    if (backend == "petsc")
+      {
+        BiLaplacianLDGLift<dim, LinearAlgebraBackends::PETSc> problem(
+          parameters, reference_data, MPI_COMM_WORLD, quiet);
+        problem.run();
+        return problem.get_cycle_results();
+      }
+#endif
+#ifdef DEAL_II_WITH_TRILINOS
+    if (backend == "trilinos")
+      {
+        BiLaplacianLDGLift<dim, LinearAlgebraBackends::Trilinos> problem(
+          parameters, reference_data, MPI_COMM_WORLD, quiet);
+        problem.run();
+        return problem.get_cycle_results();
       }
+#endif
+
+    AssertThrow(false,
+                ExcMessage("The linear algebra backend <" + backend +
+                           "> is not available in this deal.II installation "
+                           "or cannot be used with the current number of MPI "
+                           "processes."));
+    return {};
   }
 
 
 
+  // Solve all problems listed in the batch file. Every problem is small
+  // enough to be solved by one MPI process with the deal.II backend, so the
+  // processes work on different problems at the same time: whenever a
+  // process is done with a problem, it takes the next one that nobody has
+  // started yet from a counter stored on the first process. Like that,
+  // every core stays busy through all phases of the problems, including
+  // the serial ones, and large and small problems are balanced
+  // automatically. (Problems are not run concurrently on the threads of one
+  // process, since deal.II initializes MPI for calls from one thread at a
+  // time only, and creating a distributed mesh calls MPI even on
+  // MPI_COMM_SELF.) The problems are thus shared out between processes
+  // through a counter, not between threads through a work-stealing pool;
+  // the threads of a process work together on one problem at a time. The
+  // finite elements, the quadrature rules and the liftings cached on the
+  // meshes without distortion (ReferenceData) are created once per
+  // polynomial degree and process and shared by all problems of this
+  // degree, so that every configuration of faces is only lifted once per
+  // process. All other data belongs to one problem and is built anew for
+  // every problem: the mesh and the cached mapping. The throughput is
+  // printed for the whole batch and for every process.
   template <int dim>
-  void BiLaplacianLDGLift<dim>::compute_discrete_hessians(
-    const typename DoFHandler<dim>::active_cell_iterator &cell,
-    std::vector<std::vector<Tensor<2, dim>>> &            discrete_hessians,
-    std::vector<std::vector<std::vector<Tensor<2, dim>>>>
-      &discrete_hessians_neigh)
+  void run_batch(const Parameters &parameters)
   {
-    const typename Triangulation<dim>::cell_iterator cell_lift =
-      static_cast<typename Triangulation<dim>::cell_iterator>(cell);
-
-    QGauss<dim>     quad(fe.degree + 1);
-    QGauss<dim - 1> quad_face(fe.degree + 1);
-
-    const unsigned int n_q_points      = quad.size();
-    const unsigned int n_q_points_face = quad_face.size();
-
-    FEValues<dim> fe_values(fe, quad, update_hessians | update_JxW_values);
-
-    FEFaceValues<dim> fe_face(
-      fe, quad_face, update_values | update_gradients | update_normal_vectors);
-
-    FEFaceValues<dim> fe_face_neighbor(
-      fe, quad_face, update_values | update_gradients | update_normal_vectors);
-
-    const unsigned int n_dofs = fe_values.dofs_per_cell;
-
-    FEValues<dim> fe_values_lift(fe_lift,
-                                 quad,
-                                 update_values | update_JxW_values);
+    struct Problem
+    {
+      unsigned int n_refinements;
+      unsigned int fe_degree;
+      double       penalty_jump_grad;
+      double       penalty_jump_val;
+    };
 
-    FEFaceValues<dim> fe_face_lift(
-      fe_lift, quad_face, update_values | update_gradients | update_JxW_values);
+    std::vector<Problem> problems;
+    {
+      std::ifstream in(parameters.batch_file);
+      AssertThrow(in, ExcFileNotOpen(parameters.batch_file));
 
-    const FEValuesExtractors::Tensor<2> tau_ext(0);
+      std::string line;
+      while (std::getline(in, line))
+        {
+          line = line.substr(0, line.find('#'));
+          if (line.find_first_not_of(" \t") == std::string::npos)
+            continue;
+
+          std::istringstream line_stream(line);
+          Problem            problem;
+          line_stream >> problem.n_refinements >> problem.fe_degree >>
+            problem.penalty_jump_grad >> problem.penalty_jump_val;
+          AssertThrow(line_stream && problem.fe_degree >= 2,
+                      ExcMessage("Invalid problem in the batch file: " +
+                                 line));
+          problems.push_back(problem);
+        }
+    }
 
-    const unsigned int n_dofs_lift = fe_values_lift.dofs_per_cell;
-    FullMatrix<double> local_matrix_lift(n_dofs_lift, n_dofs_lift);
+    const unsigned int this_process =
+      Utilities::MPI::this_mpi_process(MPI_COMM_WORLD);
+    const unsigned int n_processes =
+      Utilities::MPI::n_mpi_processes(MPI_COMM_WORLD);
 
-    Vector<double> local_rhs_re(n_dofs_lift), local_rhs_be(n_dofs_lift),
-      coeffs_re(n_dofs_lift), coeffs_be(n_dofs_lift), coeffs_tmp(n_dofs_lift);
+    if (this_process == 0)
+      std::cout << "Solving " << problems.size() << " problems on "
+                << n_processes << " MPI processes with "
+                << MultithreadInfo::n_threads() << " threads each"
+                << std::endl;
 
-    SolverControl            solver_control(1000, 1e-12);
-    SolverCG<Vector<double>> solver(solver_control);
+    unsigned int next_problem = 0;
+    MPI_Win      window;
+    int          ierr =
+      MPI_Win_create(&next_problem,
+                     (this_process == 0 ? sizeof(next_problem) : 0),
+                     sizeof(next_problem),
+                     MPI_INFO_NULL,
+                     MPI_COMM_WORLD,
+                     &window);
+    AssertThrowMPI(ierr);
+
+    const auto take_next_problem = [&window]() {
+      const unsigned int one = 1;
+      unsigned int       problem;
+      int                ierr = MPI_Win_lock(MPI_LOCK_SHARED, 0, 0, window);
+      AssertThrowMPI(ierr);
+      ierr = MPI_Fetch_and_op(
+        &one, &problem, MPI_UNSIGNED, 0, 0, MPI_SUM, window);
+      AssertThrowMPI(ierr);
+      ierr = MPI_Win_unlock(0, window);
+      AssertThrowMPI(ierr);
+      return problem;
+    };
+
+    Timer batch_timer(MPI_COMM_WORLD, /*sync_lap_times=*/true);
+
+    std::map<unsigned int, std::shared_ptr<const ReferenceData<dim>>>
+      reference_data;
+
+    // For every problem solved by this process: its index, then the number
+    // of DoFs, the three errors and the wall time.
+    std::vector<std::pair<unsigned int, std::vector<double>>> results;
+
+    for (unsigned int p = take_next_problem(); p < problems.size();
+         p              = take_next_problem())
+      {
+        Parameters problem_parameters        = parameters;
+        problem_parameters.n_refinements     = problems[p].n_refinements;
+        problem_parameters.fe_degree         = problems[p].fe_degree;
+        problem_parameters.penalty_jump_grad = problems[p].penalty_jump_grad;
+        problem_parameters.penalty_jump_val  = problems[p].penalty_jump_val;
+
+        // The problems must not all write to the same file.
+        problem_parameters.cell_cost_output_file = "";
+
+        std::shared_ptr<const ReferenceData<dim>> &data =
+          reference_data[problems[p].fe_degree];
+        if (!data)
+          data = make_reference_data<dim>(problem_parameters);
+
+        Timer timer;
+
+        BiLaplacianLDGLift<dim, LinearAlgebraBackends::DealII> problem(
+          problem_parameters, data, MPI_COMM_SELF, /*quiet=*/true);
+        problem.run();
+
+        results.emplace_back(
+          p,
+          std::vector<double>{static_cast<double>(problem.n_dofs()),
+                              problem.get_errors().H2,
+                              problem.get_errors().H1,
+                              problem.get_errors().L2,
+                              timer.wall_time()});
+      }
 
-    double factor_avg; // 0.5 for interior faces, 1.0 for boundary faces
+    batch_timer.stop();
 
-    fe_values.reinit(cell);
-    fe_values_lift.reinit(cell_lift);
+    ierr = MPI_Win_free(&window);
+    AssertThrowMPI(ierr);
 
-    assemble_local_matrix(fe_values_lift, n_q_points, local_matrix_lift);
+    const auto all_results = Utilities::MPI::gather(MPI_COMM_WORLD, results);
+    if (this_process != 0)
+      return;
 
-    for (unsigned int i = 0; i < n_dofs; ++i)
-      for (unsigned int q = 0; q < n_q_points; ++q)
+    std::vector<std::vector<double>> sorted_results(problems.size());
+    std::vector<unsigned int>        solved_by(problems.size());
+    for (unsigned int process = 0; process < n_processes; ++process)
+      for (const auto &result : all_results[process])
         {
-          discrete_hessians[i][q] = 0;
-
-          for (unsigned int face_no = 0;
-               face_no < discrete_hessians_neigh.size();
-               ++face_no)
-            {
-              discrete_hessians_neigh[face_no][i][q] = 0;
-            }
+          sorted_results[result.first] = result.second;
+          solved_by[result.first]      = process;
         }
 
-    for (unsigned int i = 0; i < n_dofs; ++i)
+    std::ofstream out(parameters.batch_output_file);
+    out << "problem,refinements,degree,penalty_jump_grad,penalty_jump_val,"
+        << "dofs,error_H2,error_H1,error_L2,wall_time,process\n";
+
+    double                    total_dofs = 0;
+    double                    busy_time  = 0;
+    std::vector<unsigned int> problems_per_process(n_processes, 0);
+    std::vector<double>       dofs_per_process(n_processes, 0.);
+    std::vector<double>       busy_time_per_process(n_processes, 0.);
+    for (unsigned int p = 0; p < problems.size(); ++p)
       {
-        coeffs_re = 0;
-        coeffs_be = 0;
+        const std::vector<double> &result = sorted_results[p];
+        out << p << ',' << problems[p].n_refinements << ','
+            << problems[p].fe_degree << ',' << problems[p].penalty_jump_grad
+            << ',' << problems[p].penalty_jump_val << ','
+            << static_cast<types::global_dof_index>(result[0]) << ','
+            << result[1] << ',' << result[2] << ',' << result[3] << ','
+            << result[4] << ',' << solved_by[p] << '\n';
+
+        total_dofs += result[0];
+        busy_time += result[4];
+        ++problems_per_process[solved_by[p]];
+        dofs_per_process[solved_by[p]] += result[0];
+        busy_time_per_process[solved_by[p]] += result[4];
+      }
 
-        for (unsigned int face_no = 0; face_no < cell->n_faces(); ++face_no)
-          {
-            const typename DoFHandler<dim>::face_iterator face =
-              cell->face(face_no);
+    const double wall_time = batch_timer.wall_time();
+    std::cout << "Wall time of the batch: " << wall_time << " s" << std::endl
+              << "Problems per second: " << problems.size() / wall_time
+              << std::endl
+              << "Degrees of freedom per second: " << total_dofs / wall_time
+              << std::endl
+              << "Share of the time the processes were busy: "
+              << busy_time / (n_processes * wall_time) << std::endl;
+    for (unsigned int process = 0; process < n_processes; ++process)
+      std::cout << "  Process " << process << ": "
+                << problems_per_process[process] << " problems, "
+                << problems_per_process[process] / wall_time
+                << " problems per second, "
+                << dofs_per_process[process] / wall_time
+                << " degrees of freedom per second, busy "
+                << busy_time_per_process[process] / wall_time
+                << " of the time" << std::endl;
+    std::cout << "Results written to " << parameters.batch_output_file
+              << std::endl;
+  }
 
-            const bool at_boundary = face->at_boundary();
 
-            factor_avg = 0.5;
-            if (at_boundary)
-              {
-                factor_avg = 1.0;
-              }
 
-            fe_face.reinit(cell, face_no);
-            fe_face_lift.reinit(cell_lift, face_no);
+  // Solve the problem on a sequence of globally refined meshes for every
+  // polynomial degree of the convergence study. For each degree, a single
+  // problem refines its triangulation in place from the minimal to the
+  // maximal number of refinements and distributes the DoFs anew on every
+  // mesh, so that the coarse mesh and the finite elements and quadrature
+  // rules of the degree are only created once. The liftings cached with
+  // them on the unit square or cube therefore survive the refinements: from
+  // two refinements on, a globally refined Cartesian mesh has the same
+  // configurations of faces on every level, so they are all computed on the
+  // first mesh and only rescaled on the finer ones, which dominate the cost
+  // of the study. The order of convergence of every error between two
+  // successive meshes is log2 of the ratio of the errors, since every
+  // refinement halves the mesh size. The errors, the orders and the wall
+  // time of every phase on every mesh are written to the output file, as
+  // CSV or JSON, and the errors and orders are printed.
+  template <int dim>
+  void run_convergence_study(const Parameters &parameters)
+  {
+    AssertThrow(parameters.convergence_min_refinements <=
+                  parameters.convergence_max_refinements,
+                ExcMessage("The minimal number of refinements of the "
+                           "convergence study exceeds the maximal one."));
 
-            local_rhs_re = 0;
-            for (unsigned int q = 0; q < n_q_points_face; ++q)
-              {
-                const double         dx     = fe_face_lift.JxW(q);
-                const Tensor<1, dim> normal = fe_face.normal_vector(
-                  q); // same as fe_face_lift.normal_vector(q)
+    struct Level
+    {
+      unsigned int          fe_degree;
+      unsigned int          n_refinements;
+      CycleResults          results;
+      std::array<double, 3> rates;
+    };
+    std::vector<Level> levels;
+
+    for (const unsigned int fe_degree : parameters.convergence_degrees)
+      {
+        Parameters study_parameters    = parameters;
+        study_parameters.fe_degree     = fe_degree;
+        study_parameters.refinement    = "global";
+        study_parameters.n_refinements = parameters.convergence_min_refinements;
 
-                for (unsigned int m = 0; m < n_dofs_lift; ++m)
-                  {
-                    local_rhs_re(m) +=
-                      factor_avg *
-                      (fe_face_lift[tau_ext].value(m, q) * normal) *
-                      fe_face.shape_grad(i, q) * dx;
-                  }
-              }
+        study_parameters.n_cycles = parameters.convergence_max_refinements -
+                                    parameters.convergence_min_refinements + 1;
 
-            local_rhs_be = 0;
-            for (unsigned int q = 0; q < n_q_points_face; ++q)
-              {
-                const double         dx     = fe_face_lift.JxW(q);
-                const Tensor<1, dim> normal = fe_face.normal_vector(
-                  q); // same as fe_face_lift.normal_vector(q)
+        const std::vector<CycleResults> cycle_results =
+          run_problem<dim>(study_parameters, /*quiet=*/true);
 
-                for (unsigned int m = 0; m < n_dofs_lift; ++m)
-                  {
-                    local_rhs_be(m) += factor_avg *
-                                       fe_face_lift[tau_ext].divergence(m, q) *
-                                       normal * fe_face.shape_value(i, q) * dx;
-                  }
+        for (unsigned int cycle = 0; cycle < cycle_results.size(); ++cycle)
+          {
+            Level level;
+            level.fe_degree     = fe_degree;
+            level.n_refinements = study_parameters.n_refinements + cycle;
+            level.results       = cycle_results[cycle];
+            level.rates.fill(std::numeric_limits<double>::quiet_NaN());
+            if (cycle > 0)
+              {
+                const ErrorNorms &coarse = cycle_results[cycle - 1].errors;
+                const ErrorNorms &fine   = cycle_results[cycle].errors;
+                level.rates = {{std::log2(coarse.H2 / fine.H2),
+                                std::log2(coarse.H1 / fine.H1),
+                                std::log2(coarse.L2 / fine.L2)}};
               }
+            levels.push_back(level);
+          }
+      }
 
-            coeffs_tmp = 0;
-            solver.solve(local_matrix_lift,
-                         coeffs_tmp,
-                         local_rhs_re,
-                         PreconditionIdentity());
-            coeffs_re += coeffs_tmp;
-
-            coeffs_tmp = 0;
-            solver.solve(local_matrix_lift,
-                         coeffs_tmp,
-                         local_rhs_be,
-                         PreconditionIdentity());
-            coeffs_be += coeffs_tmp;
-
-          } // for face
+    if (Utilities::MPI::this_mpi_process(MPI_COMM_WORLD) != 0)
+      return;
 
-        for (unsigned int q = 0; q < n_q_points; ++q)
+    std::cout << "degree refinements       dofs   error_H2  rate   "
+              << "error_H1  rate   error_L2  rate" << std::endl;
+    for (const Level &level : levels)
+      {
+        std::cout << std::setw(6) << level.fe_degree << std::setw(12)
+                  << level.n_refinements << std::setw(11)
+                  << level.results.n_dofs << std::scientific
+                  << std::setprecision(3);
+        const std::array<double, 3> errors = {{level.results.errors.H2,
+                                               level.results.errors.H1,
+                                               level.results.errors.L2}};
+        for (unsigned int k = 0; k < 3; ++k)
           {
-            discrete_hessians[i][q] += fe_values.shape_hessian(i, q);
+            std::cout << std::setw(11) << errors[k] << std::fixed
+                      << std::setprecision(2) << std::setw(6);
+            if (std::isnan(level.rates[k]))
+              std::cout << '-';
+            else
+              std::cout << level.rates[k];
+            std::cout << std::scientific << std::setprecision(3);
+          }
+        std::cout << std::defaultfloat << std::setprecision(6) << std::endl;
+      }
 
-            for (unsigned int m = 0; m < n_dofs_lift; ++m)
-              {
-                discrete_hessians[i][q] -=
-                  coeffs_re[m] * fe_values_lift[tau_ext].value(m, q);
-              }
+    // The rate of the first mesh of every degree is left empty in the CSV
+    // file and is null in the JSON file.
+    std::ofstream out(parameters.convergence_output_file);
+    out << std::setprecision(10);
+    const std::array<std::string, 3> norms = {{"H2", "H1", "L2"}};
 
-            for (unsigned int m = 0; m < n_dofs_lift; ++m)
+    if (parameters.convergence_output_format == "csv")
+      {
+        out << "degree,refinements,cells,dofs";
+        for (const std::string &norm : norms)
+          out << ",error_" << norm << ",rate_" << norm;
+        for (const std::string &phase : timed_phases)
+          out << ',' << phase_column_name(phase);
+        out << '\n';
+
+        for (const Level &level : levels)
+          {
+            const std::array<double, 3> errors = {{level.results.errors.H2,
+                                                   level.results.errors.H1,
+                                                   level.results.errors.L2}};
+            out << level.fe_degree << ',' << level.n_refinements << ','
+                << level.results.n_cells << ',' << level.results.n_dofs;
+            for (unsigned int k = 0; k < 3; ++k)
               {
-                discrete_hessians[i][q] +=
-                  coeffs_be[m] * fe_values_lift[tau_ext].value(m, q);
+                out << ',' << errors[k] << ',';
+                if (!std::isnan(level.rates[k]))
+                  out << level.rates[k];
               }
+            for (const double time : level.results.wall_times)
+              out << ',' << time;
+            out << '\n';
           }
-      } // for dof i
-
-
-
-    for (unsigned int face_no = 0; face_no < cell->n_faces(); ++face_no)
+      }
+    else
       {
-        const typename DoFHandler<dim>::face_iterator face =
-          cell->face(face_no);
-
-        const bool at_boundary = face->at_boundary();
-
-        if (!at_boundary)
+        out << "[\n";
+        for (unsigned int l = 0; l < levels.size(); ++l)
           {
-            const typename DoFHandler<2, dim>::active_cell_iterator
-                               neighbor_cell = cell->neighbor(face_no);
-            const unsigned int face_no_neighbor =
-              cell->neighbor_of_neighbor(face_no);
-            fe_face_neighbor.reinit(neighbor_cell, face_no_neighbor);
-
-            for (unsigned int i = 0; i < n_dofs; ++i)
+            const Level &               level  = levels[l];
+            const std::array<double, 3> errors = {{level.results.errors.H2,
+                                                   level.results.errors.H1,
+                                                   level.results.errors.L2}};
+            out << "  {\"degree\": " << level.fe_degree
+                << ", \"refinements\": " << level.n_refinements
+                << ", \"cells\": " << level.results.n_cells
+                << ", \"dofs\": " << level.results.n_dofs;
+            for (unsigned int k = 0; k < 3; ++k)
               {
-                coeffs_re = 0;
-                coeffs_be = 0;
-
-                fe_face_lift.reinit(cell_lift, face_no);
-
-                local_rhs_re = 0;
-                for (unsigned int q = 0; q < n_q_points_face; ++q)
-                  {
-                    const double         dx = fe_face_lift.JxW(q);
-                    const Tensor<1, dim> normal =
-                      fe_face_neighbor.normal_vector(q);
-
-                    for (unsigned int m = 0; m < n_dofs_lift; ++m)
-                      {
-                        local_rhs_re(m) +=
-                          0.5 * (fe_face_lift[tau_ext].value(m, q) * normal) *
-                          fe_face_neighbor.shape_grad(i, q) * dx;
-                      }
-                  }
-
-                local_rhs_be = 0;
-                for (unsigned int q = 0; q < n_q_points_face; ++q)
-                  {
-                    const double         dx = fe_face_lift.JxW(q);
-                    const Tensor<1, dim> normal =
-                      fe_face_neighbor.normal_vector(q);
-
-                    for (unsigned int m = 0; m < n_dofs_lift; ++m)
-                      {
-                        local_rhs_be(m) +=
-                          0.5 * fe_face_lift[tau_ext].divergence(m, q) *
-                          normal * fe_face_neighbor.shape_value(i, q) * dx;
-                      }
-                  }
-
-                solver.solve(local_matrix_lift,
-                             coeffs_re,
-                             local_rhs_re,
-                             PreconditionIdentity());
-                solver.solve(local_matrix_lift,
-                             coeffs_be,
-                             local_rhs_be,
-                             PreconditionIdentity());
-
-                for (unsigned int q = 0; q < n_q_points; ++q)
-                  {
-                    for (unsigned int m = 0; m < n_dofs_lift; ++m)
-                      {
-                        discrete_hessians_neigh[face_no][i][q] -=
-                          coeffs_re[m] * fe_values_lift[tau_ext].value(m, q);
-                      }
-
-                    for (unsigned int m = 0; m < n_dofs_lift; ++m)
-                      {
-                        discrete_hessians_neigh[face_no][i][q] +=
-                          coeffs_be[m] * fe_values_lift[tau_ext].value(m, q);
-                      }
-                  }
-
-              } // for dof i
-          }     // boundary check
-      }         // for face
-  }
-
-
-
-  template <int dim>
-  void BiLaplacianLDGLift<dim>::run()
-  {
-    make_grid();
-
-    setup_system();
-    assemble_system();
-
-    solve();
+                out << ", \"error_" << norms[k] << "\": " << errors[k]
+                    << ", \"rate_" << norms[k] << "\": ";
+                if (std::isnan(level.rates[k]))
+                  out << "null";
+                else
+                  out << level.rates[k];
+              }
+            out << ", \"wall_times\": {";
+            for (unsigned int i = 0; i < timed_phases.size(); ++i)
+              out << (i > 0 ? ", " : "") << '"'
+                  << phase_column_name(timed_phases[i])
+                  << "\": " << level.results.wall_times[i];
+            out << "}}" << (l + 1 < levels.size() ? "," : "") << '\n';
+          }
+        out << "]\n";
+      }
 
-    compute_errors();
-    output_results();
+    std::cout << "Results written to " << parameters.convergence_output_file
+              << std::endl;
   }
 
 } // namespace Step82
 
 
 
-int main()
+int main(int argc, char *argv[])
 {
   try
     {
-      const unsigned int n_ref = 3; // number of mesh refinements
-
-      const unsigned int degree =
-        2; // FE degree for u_h and the two lifting terms
-
-      const double penalty_grad =
-        1.0; // penalty coefficient for the jump of the gradients
-      const double penalty_val =
-        1.0; // penalty coefficient for the jump of the values
-
-      Step82::BiLaplacianLDGLift<2> problem(n_ref,
-                                            degree,
-                                            penalty_grad,
-                                            penalty_val);
-
-      problem.run();
+      using namespace dealii;
+
+      // Unless the parameter file says otherwise, every MPI process uses
+      // as many threads as there are cores on its node divided by the
+      // number of processes on that node.
+      Utilities::MPI::MPI_InitFinalize mpi_initialization(
+        argc, argv, numbers::invalid_unsigned_int);
+
+      ParameterHandler prm;
+      Step82::Parameters::declare_parameters(prm);
+      if (argc > 1)
+        prm.parse_input(argv[1]);
+
+      Step82::Parameters parameters;
+      parameters.parse_parameters(prm);
+
+      if (parameters.n_threads > 0)
+        MultithreadInfo::set_thread_limit(parameters.n_threads);
+
+#ifdef STEP82_WITH_THREAD_PINNING
+      std::unique_ptr<Step82::ThreadPinning> thread_pinning;
+      if (parameters.pin_threads)
+        thread_pinning = std::make_unique<Step82::ThreadPinning>();
+#else
+      if (parameters.pin_threads &&
+          Utilities::MPI::this_mpi_process(MPI_COMM_WORLD) == 0)
+        std::cerr << "Pinning threads is not supported on this platform, "
+                  << "the threads are left unpinned." << std::endl;
+#endif
+
+      if (parameters.run_mode == "batch")
+        {
+          if (parameters.dimension == 3)
+            Step82::run_batch<3>(parameters);
+          else
+            Step82::run_batch<2>(parameters);
+        }
+      else if (parameters.run_mode == "convergence")
+        {
+          if (parameters.dimension == 3)
+            Step82::run_convergence_study<3>(parameters);
+          else
+            Step82::run_convergence_study<2>(parameters);
+        }
+      else if (parameters.dimension == 3)
+        Step82::run_problem<3>(parameters);
+      else
+        Step82::run_problem<2>(parameters);
     }
   catch (std::exception &exc)
     {